@@ -0,0 +1,20 @@
+#include "ChunkedIpPool_c.hpp"
+
+#include <algorithm>  // std::min
+
+
+
+ip_pool_t ChunkedIpPool_c::release()
+{
+    ip_pool_t ip_pool;
+    ip_pool.reserve(m_size);
+    for (size_t c = 0; c < m_chunks.size(); ++c)
+    {
+        const size_t n = std::min(CHUNK_SIZE, m_size - c * CHUNK_SIZE);
+        ip_pool.insert(ip_pool.end(), m_chunks[c].get(), m_chunks[c].get() + n);
+        m_chunks[c].reset();
+    }
+    m_chunks.clear();
+    m_size = 0;
+    return ip_pool;
+}
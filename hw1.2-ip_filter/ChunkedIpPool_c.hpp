@@ -0,0 +1,97 @@
+#pragma once
+
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "IpV4_c.hpp"
+
+
+
+// A pool growing by fixed-size chunks: appending never moves or copies the
+// stored addresses, so there is neither a reallocation copy nor a 2x peak of
+// memory. Elements are addressed by (chunk, offset) and the iterators are
+// random-access ones, so std::sort and other algorithms work as is.
+class ChunkedIpPool_c
+{
+public:
+    static constexpr size_t CHUNK_BITS = 16;
+    // 64Ki addresses (256 KiB) per chunk
+    static constexpr size_t CHUNK_SIZE = size_t{1} << CHUNK_BITS;
+
+    template <typename Pool, typename Value>
+    class iterator_c
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = IpV4_c;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = Value*;
+        using reference         = Value&;
+
+        iterator_c() noexcept = default;
+        iterator_c(Pool* pool, size_t pos) noexcept : m_pool(pool), m_pos(pos) {}
+
+        reference operator*() const noexcept                 { return (*m_pool)[m_pos]; }
+        pointer   operator->() const noexcept                { return &**this; }
+        reference operator[](difference_type n) const noexcept { return (*m_pool)[m_pos + n]; }
+
+        iterator_c& operator++() noexcept                    { ++m_pos; return *this; }
+        iterator_c& operator--() noexcept                    { --m_pos; return *this; }
+        iterator_c  operator++(int) noexcept                 { iterator_c it = *this; ++m_pos; return it; }
+        iterator_c  operator--(int) noexcept                 { iterator_c it = *this; --m_pos; return it; }
+        iterator_c& operator+=(difference_type n) noexcept   { m_pos += n; return *this; }
+        iterator_c& operator-=(difference_type n) noexcept   { m_pos -= n; return *this; }
+        iterator_c  operator+(difference_type n) const noexcept { return {m_pool, m_pos + n}; }
+        iterator_c  operator-(difference_type n) const noexcept { return {m_pool, m_pos - n}; }
+        friend iterator_c operator+(difference_type n, const iterator_c& it) noexcept { return it + n; }
+        difference_type operator-(const iterator_c& o) const noexcept
+        {
+            return static_cast<difference_type>(m_pos) - static_cast<difference_type>(o.m_pos);
+        }
+
+        bool operator==(const iterator_c& o) const noexcept { return m_pos == o.m_pos; }
+        bool operator!=(const iterator_c& o) const noexcept { return m_pos != o.m_pos; }
+        bool operator<(const iterator_c& o) const noexcept  { return m_pos < o.m_pos; }
+        bool operator>(const iterator_c& o) const noexcept  { return m_pos > o.m_pos; }
+        bool operator<=(const iterator_c& o) const noexcept { return m_pos <= o.m_pos; }
+        bool operator>=(const iterator_c& o) const noexcept { return m_pos >= o.m_pos; }
+
+    private:
+        Pool*     m_pool = nullptr;
+        size_t    m_pos  = 0;
+    };
+
+    using iterator       = iterator_c<ChunkedIpPool_c, IpV4_c>;
+    using const_iterator = iterator_c<const ChunkedIpPool_c, const IpV4_c>;
+
+    void push_back(IpV4_c ip)
+    {
+        if ((m_size & (CHUNK_SIZE - 1)) == 0 && (m_size >> CHUNK_BITS) == m_chunks.size())
+        {
+            m_chunks.emplace_back(new IpV4_c[CHUNK_SIZE]);
+        }
+        (*this)[m_size++] = ip;
+    }
+    void emplace_back(std::string_view str) { push_back(IpV4_c{str}); }
+
+    IpV4_c&       operator[](size_t i) noexcept       { return m_chunks[i >> CHUNK_BITS][i & (CHUNK_SIZE - 1)]; }
+    const IpV4_c& operator[](size_t i) const noexcept { return m_chunks[i >> CHUNK_BITS][i & (CHUNK_SIZE - 1)]; }
+
+    size_t size()  const noexcept { return m_size; }
+    bool   empty() const noexcept { return m_size == 0; }
+
+    iterator       begin() noexcept       { return {this, 0}; }
+    iterator       end() noexcept         { return {this, m_size}; }
+    const_iterator begin() const noexcept { return {this, 0}; }
+    const_iterator end() const noexcept   { return {this, m_size}; }
+
+    // Moves the addresses to a contiguous pool freeing every chunk as soon
+    // as it's copied, so the peak is the pool plus one chunk.
+    ip_pool_t release();
+
+private:
+    std::vector<std::unique_ptr<IpV4_c[]>>    m_chunks;
+    size_t                                    m_size = 0;
+};
@@ -0,0 +1,222 @@
+#include "ExternalSorter_c.hpp"
+
+#include <algorithm>     // std::min, std::max
+#include <queue>
+#include <system_error>  // std::system_error
+
+#include <cerrno>
+
+#include "FilterKernels.hpp"
+
+
+
+KeyFile_c::KeyFile_c()
+    : m_file{std::tmpfile()}
+{
+    if (m_file == nullptr)
+    {
+        throw std::system_error(errno, std::generic_category(), "Can't create a temporary file");
+    }
+    std::setvbuf(m_file, nullptr, _IOFBF, 1 << 16);
+}
+
+
+
+KeyFile_c::~KeyFile_c()
+{
+    std::fclose(m_file);
+}
+
+
+
+void KeyFile_c::write(const uint32_t* keys, size_t n)
+{
+    if (std::fwrite(keys, sizeof(*keys), n, m_file) != n)
+    {
+        throw std::system_error(errno, std::generic_category(), "Can't write a temporary file");
+    }
+    m_size += n;
+}
+
+
+
+void KeyFile_c::rewind()
+{
+    if (std::fflush(m_file) != 0 || std::fseek(m_file, 0, SEEK_SET) != 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "Can't rewind a temporary file");
+    }
+}
+
+
+
+size_t KeyFile_c::read(uint32_t* keys, size_t n)
+{
+    const size_t read = std::fread(keys, sizeof(*keys), n, m_file);
+    if (read == 0 && std::ferror(m_file))
+    {
+        throw std::system_error(errno, std::generic_category(), "Can't read a temporary file");
+    }
+    return read;
+}
+
+
+
+namespace {
+
+// A buffered reader of a spilled run.
+struct run_reader_s
+{
+    static constexpr size_t BUFFER_SIZE = 1 << 14;
+
+    explicit run_reader_s(KeyFile_c& run)
+        : file{&run}
+        , buffer(BUFFER_SIZE)
+    {
+        run.rewind();
+    }
+
+    // Returns false at the end of the run.
+    bool next(uint32_t& key)
+    {
+        if (pos == size)
+        {
+            size = file->read(buffer.data(), buffer.size());
+            pos  = 0;
+            if (size == 0) { return false; }
+        }
+        key = buffer[pos++];
+        return true;
+    }
+
+    KeyFile_c*               file;
+    std::vector<uint32_t>    buffer;
+    size_t                   pos  = 0;
+    size_t                   size = 0;
+};
+
+} // namespace
+
+
+
+ExternalSorter_c::ExternalSorter_c(size_t run_size, utils::sort_order_e order)
+    : m_run_size{std::max<size_t>(run_size, 1)}
+    , m_order{order}
+{
+    m_run.reserve(m_run_size);
+}
+
+
+
+size_t ExternalSorter_c::size() const noexcept
+{
+    size_t size = m_run.size();
+    for (const run_s& run : m_runs) { size += run.file->size(); }
+    return size;
+}
+
+
+
+void ExternalSorter_c::spill()
+{
+    utils::radix_sort(m_run, m_scratch, m_order);
+    auto file = std::make_unique<KeyFile_c>();
+    file->write(kernels::keys_of(m_run.data()), m_run.size());
+    m_runs.push_back({std::move(file), 0});
+    m_run.clear();
+
+    //NOTE: the runs are appended by levels from the highest one, so the
+    //      runs of the last level are the tail
+    while (m_runs.size() >= MAX_MERGE_WAYS)
+    {
+        const size_t first = m_runs.size() - MAX_MERGE_WAYS;
+        if (m_runs[first].level != m_runs.back().level) { break; }
+        merge_tail(first);
+    }
+}
+
+
+
+void ExternalSorter_c::merge_tail(size_t first)
+{
+    auto file = std::make_unique<KeyFile_c>();
+    merge_runs(first, m_runs.size(), [&file](uint32_t key) { file->write(&key, 1); });
+    const size_t level = m_runs[first].level + 1;
+    m_runs.resize(first);
+    m_runs.push_back({std::move(file), level});
+}
+
+
+
+void ExternalSorter_c::merge(void (*on_block)(ip_pool_t&, void*), void* ctx)
+{
+    ip_pool_t block;
+    block.reserve(BLOCK_SIZE);
+
+    if (m_runs.empty())
+    {
+        //NOTE: everything fits into memory, the files aren't needed
+        utils::radix_sort(m_run, m_scratch, m_order);
+        for (size_t begin = 0; begin < m_run.size(); begin += BLOCK_SIZE)
+        {
+            const size_t end = std::min(begin + BLOCK_SIZE, m_run.size());
+            block.assign(m_run.begin() + begin, m_run.begin() + end);
+            on_block(block, ctx);
+        }
+        return;
+    }
+    if (not m_run.empty()) { spill(); }
+    //NOTE: the buffers aren't needed anymore, give the memory to the readers
+    ip_pool_t{}.swap(m_run);
+    ip_pool_t{}.swap(m_scratch);
+
+    //NOTE: the number of open files and read buffers is bounded, so too
+    //      many runs are merged into longer ones by extra passes from the
+    //      shortest ones
+    while (m_runs.size() > MAX_MERGE_WAYS)
+    {
+        merge_tail(m_runs.size() - MAX_MERGE_WAYS);
+    }
+
+    merge_runs(0, m_runs.size(), [&](uint32_t key)
+    {
+        block.push_back(IpV4_c::from_key(key));
+        if (block.size() == BLOCK_SIZE)
+        {
+            on_block(block, ctx);
+            block.clear();
+        }
+    });
+    if (not block.empty()) { on_block(block, ctx); }
+    m_runs.clear();
+}
+
+
+
+template <typename F>
+void ExternalSorter_c::merge_runs(size_t first, size_t last, F&& on_key)
+{
+    std::vector<run_reader_s> readers;
+    readers.reserve(last - first);
+    for (size_t r = first; r < last; ++r) { readers.emplace_back(*m_runs[r].file); }
+
+    //NOTE: the heap pops the greatest element, so the keys are inverted
+    //      for the ascending order
+    const uint32_t inversion = (m_order == utils::sort_order_e::ASC) ? UINT32_MAX : 0;
+    using item_t = std::pair<uint32_t, size_t>;  // (key ^ inversion, reader)
+    std::priority_queue<item_t> heap;
+    for (size_t r = 0; r < readers.size(); ++r)
+    {
+        uint32_t key;
+        if (readers[r].next(key)) { heap.emplace(key ^ inversion, r); }
+    }
+
+    while (not heap.empty())
+    {
+        const auto [key, r] = heap.top();
+        heap.pop();
+        on_key(key ^ inversion);
+        uint32_t next;
+        if (readers[r].next(next)) { heap.emplace(next ^ inversion, r); }
+    }
+}
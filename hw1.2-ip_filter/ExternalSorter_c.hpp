@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdio>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "IpV4_c.hpp"
+#include "IpPoolSort.hpp"
+
+
+
+// A temporary binary file of packed keys, removed on close.
+class KeyFile_c
+{
+public:
+    KeyFile_c();
+    ~KeyFile_c();
+    KeyFile_c(const KeyFile_c&)            = delete;
+    KeyFile_c& operator=(const KeyFile_c&) = delete;
+
+    void write(const uint32_t* keys, size_t n);
+    void write(IpV4_c ip) { const uint32_t key = ip.key(); write(&key, 1); }
+    // Switches the file from writing to reading from the beginning.
+    void rewind();
+    // Returns the number of read keys, 0 at the end of the file.
+    size_t read(uint32_t* keys, size_t n);
+
+    size_t size() const noexcept { return m_size; }
+
+private:
+    FILE*     m_file = nullptr;
+    size_t    m_size = 0;
+};
+
+
+
+// Sorts more addresses than fit into memory: every `run_size` added
+// addresses are radix sorted and spilled to a KeyFile_c, then the runs are
+// merged by a k-way heap merge of at most MAX_MERGE_WAYS runs at once.
+// Runs of the same level are merged into a run of the next level as soon
+// as there are MAX_MERGE_WAYS of them, so the number of open temporary
+// files grows by the logarithm of the input size only.
+// Memory is about 2 * run_size addresses (the run and the radix sort
+// scratch) plus 128 KiB per merged run: its 64 KiB read buffer and the
+// 64 KiB stdio buffer of its file.
+class ExternalSorter_c
+{
+public:
+    static constexpr size_t BLOCK_SIZE     = 1024;
+    static constexpr size_t MAX_MERGE_WAYS = 16;
+
+    ExternalSorter_c(size_t run_size, utils::sort_order_e);
+
+    void add(IpV4_c ip)
+    {
+        m_run.push_back(ip);
+        if (m_run.size() == m_run_size) { spill(); }
+    }
+
+    // The number of added addresses, valid till merge(). O(runs).
+    size_t size() const noexcept;
+    // The number of runs in temporary files: at most MAX_MERGE_WAYS - 1 of
+    // every level.
+    size_t runs() const noexcept { return m_runs.size(); }
+
+    // Calls `on_block(ip_pool_t&)` with consecutive blocks (at most
+    // BLOCK_SIZE addresses) of all added addresses in the sorted order.
+    // Can be called once.
+    void merge(void (*on_block)(ip_pool_t&, void*), void* ctx);
+
+    template <typename F>
+    void merge(F&& on_block)
+    {
+        using func_t = std::remove_reference_t<F>;
+        merge([](ip_pool_t& block, void* ctx) { (*static_cast<func_t*>(ctx))(block); },
+              &on_block);
+    }
+
+private:
+    struct run_s
+    {
+        std::unique_ptr<KeyFile_c>    file;
+        // A spilled run is of level 0, a merge of runs of level L is of L + 1.
+        size_t                        level = 0;
+    };
+
+    void spill();
+    // Replaces the runs [first, end) by their merge, the merged runs are
+    // removed as soon as it's written.
+    void merge_tail(size_t first);
+    // Merges the runs [first, last) calling `on_key(uint32_t)`.
+    template <typename F>
+    void merge_runs(size_t first, size_t last, F&& on_key);
+
+    size_t                  m_run_size;
+    utils::sort_order_e     m_order;
+    ip_pool_t               m_run;
+    ip_pool_t               m_scratch;
+    std::vector<run_s>      m_runs;
+};
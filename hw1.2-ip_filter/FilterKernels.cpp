@@ -0,0 +1,277 @@
+#include "FilterKernels.hpp"
+
+#include <algorithm>  // std::min
+
+#if defined(__x86_64__) || defined(__i386__)
+#    define IP_FILTER_X86
+#    include <immintrin.h>
+#endif
+
+
+
+namespace kernels {
+
+namespace {
+
+size_t match_mask_scalar(const uint32_t* keys, size_t size, mask_key_s mk, uint32_t* out_idx) noexcept
+{
+    size_t n = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        out_idx[n] = static_cast<uint32_t>(i);
+        n += mk.match(keys[i]);
+    }
+    return n;
+}
+
+
+size_t match_any_byte_scalar(const uint32_t* keys, size_t size, uint8_t byte, uint32_t* out_idx) noexcept
+{
+    //NOTE: the SWAR trick: a byte of `x` is zero iff the related byte of
+    //      (x - 0x01..01) & ~x & 0x80..80 is not zero
+    const uint32_t pattern = 0x01010101u * byte;
+    size_t n = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        const uint32_t x = keys[i] ^ pattern;
+        out_idx[n] = static_cast<uint32_t>(i);
+        n += ((x - 0x01010101u) & ~x & 0x80808080u) != 0;
+    }
+    return n;
+}
+
+
+#ifdef IP_FILTER_X86
+
+// Writes `base + bit` for every set bit of `bits`.
+inline size_t compress(unsigned bits, uint32_t base, uint32_t* out_idx) noexcept
+{
+    size_t n = 0;
+    while (bits)
+    {
+        out_idx[n++] = base + static_cast<uint32_t>(__builtin_ctz(bits));
+        bits &= bits - 1;
+    }
+    return n;
+}
+
+
+__attribute__((target("sse2")))
+size_t match_mask_sse2(const uint32_t* keys, size_t size, mask_key_s mk, uint32_t* out_idx) noexcept
+{
+    const __m128i value   = _mm_set1_epi32(static_cast<int>(mk.value));
+    const __m128i bitmask = _mm_set1_epi32(static_cast<int>(mk.bitmask));
+    size_t n = 0;
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+        const __m128i k  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+        const __m128i eq = _mm_cmpeq_epi32(_mm_and_si128(k, bitmask), value);
+        n += compress(_mm_movemask_ps(_mm_castsi128_ps(eq)), i, out_idx + n);
+    }
+    for (size_t t = match_mask_scalar(keys + i, size - i, mk, out_idx + n); t; --t, ++n)
+    {
+        out_idx[n] += i;
+    }
+    return n;
+}
+
+
+__attribute__((target("sse2")))
+size_t match_any_byte_sse2(const uint32_t* keys, size_t size, uint8_t byte, uint32_t* out_idx) noexcept
+{
+    const __m128i pattern = _mm_set1_epi8(static_cast<char>(byte));
+    const __m128i zero    = _mm_setzero_si128();
+    size_t n = 0;
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+        const __m128i k    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+        //NOTE: a 32-bit lane without equal bytes is zero after the byte compare
+        const __m128i none = _mm_cmpeq_epi32(_mm_cmpeq_epi8(k, pattern), zero);
+        n += compress(~_mm_movemask_ps(_mm_castsi128_ps(none)) & 0xF, i, out_idx + n);
+    }
+    for (size_t t = match_any_byte_scalar(keys + i, size - i, byte, out_idx + n); t; --t, ++n)
+    {
+        out_idx[n] += i;
+    }
+    return n;
+}
+
+
+__attribute__((target("avx2")))
+size_t match_mask_avx2(const uint32_t* keys, size_t size, mask_key_s mk, uint32_t* out_idx) noexcept
+{
+    const __m256i value   = _mm256_set1_epi32(static_cast<int>(mk.value));
+    const __m256i bitmask = _mm256_set1_epi32(static_cast<int>(mk.bitmask));
+    size_t n = 0;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        const __m256i k  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        const __m256i eq = _mm256_cmpeq_epi32(_mm256_and_si256(k, bitmask), value);
+        n += compress(_mm256_movemask_ps(_mm256_castsi256_ps(eq)), i, out_idx + n);
+    }
+    for (size_t t = match_mask_sse2(keys + i, size - i, mk, out_idx + n); t; --t, ++n)
+    {
+        out_idx[n] += i;
+    }
+    return n;
+}
+
+
+__attribute__((target("avx2")))
+size_t match_any_byte_avx2(const uint32_t* keys, size_t size, uint8_t byte, uint32_t* out_idx) noexcept
+{
+    const __m256i pattern = _mm256_set1_epi8(static_cast<char>(byte));
+    const __m256i zero    = _mm256_setzero_si256();
+    size_t n = 0;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        const __m256i k    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        const __m256i none = _mm256_cmpeq_epi32(_mm256_cmpeq_epi8(k, pattern), zero);
+        n += compress(~_mm256_movemask_ps(_mm256_castsi256_ps(none)) & 0xFF, i, out_idx + n);
+    }
+    for (size_t t = match_any_byte_sse2(keys + i, size - i, byte, out_idx + n); t; --t, ++n)
+    {
+        out_idx[n] += i;
+    }
+    return n;
+}
+
+#endif // IP_FILTER_X86
+
+
+using match_mask_f     = size_t (*)(const uint32_t*, size_t, mask_key_s, uint32_t*) noexcept;
+using match_any_byte_f = size_t (*)(const uint32_t*, size_t, uint8_t, uint32_t*) noexcept;
+
+match_mask_f get_match_mask(isa_e isa) noexcept
+{
+    switch (isa)
+    {
+#ifdef IP_FILTER_X86
+        case isa_e::AVX2: return match_mask_avx2;
+        case isa_e::SSE2: return match_mask_sse2;
+#endif
+        default:          return match_mask_scalar;
+    }
+}
+
+match_any_byte_f get_match_any_byte(isa_e isa) noexcept
+{
+    switch (isa)
+    {
+#ifdef IP_FILTER_X86
+        case isa_e::AVX2: return match_any_byte_avx2;
+        case isa_e::SSE2: return match_any_byte_sse2;
+#endif
+        default:          return match_any_byte_scalar;
+    }
+}
+
+
+template <typename Kernel>
+void collect(IpV4_c* first, size_t size, filtered_ip_pool_t& out, Kernel kernel)
+{
+    constexpr size_t BLOCK_SIZE = 1024;
+    uint32_t idx[BLOCK_SIZE];
+    for (size_t begin = 0; begin < size; begin += BLOCK_SIZE)
+    {
+        const size_t n = kernel(keys_of(first + begin), std::min(BLOCK_SIZE, size - begin), idx);
+        out.push_back(static_cast<uint32_t>(first + begin - out.base()), idx, n);
+    }
+}
+
+} // namespace
+
+
+
+bool is_supported(isa_e isa) noexcept
+{
+    switch (isa)
+    {
+        case isa_e::SCALAR: return true;
+#ifdef IP_FILTER_X86
+        case isa_e::SSE2:   return __builtin_cpu_supports("sse2");
+        case isa_e::AVX2:   return __builtin_cpu_supports("avx2");
+#endif
+        default:            return false;
+    }
+}
+
+
+isa_e best_isa() noexcept
+{
+    static const isa_e isa = is_supported(isa_e::AVX2) ? isa_e::AVX2
+                           : is_supported(isa_e::SSE2) ? isa_e::SSE2
+                           :                             isa_e::SCALAR;
+    return isa;
+}
+
+
+mask_key_s make_mask_key(const IpV4_c::mask_t& mask) noexcept
+{
+    mask_key_s mk;
+    for (size_t i = 0; i < mask.size(); ++i)
+    {
+        mk.value   <<= 8;
+        mk.bitmask <<= 8;
+        if (mask[i] == IpV4_c::MATCH_SKIP_BYTE) { continue; }
+        if (mask[i] < 0 || mask[i] > UINT8_MAX)
+        {
+            //NOTE: a value bit outside of the bitmask never matches
+            return mask_key_s{1, 0};
+        }
+        mk.value   |= static_cast<uint32_t>(mask[i]);
+        mk.bitmask |= UINT8_MAX;
+    }
+    return mk;
+}
+
+
+size_t match_mask(isa_e isa, const uint32_t* keys, size_t size, mask_key_s mk, uint32_t* out_idx) noexcept
+{
+    return get_match_mask(isa)(keys, size, mk, out_idx);
+}
+
+
+size_t match_any_byte(isa_e isa, const uint32_t* keys, size_t size, uint8_t byte, uint32_t* out_idx) noexcept
+{
+    return get_match_any_byte(isa)(keys, size, byte, out_idx);
+}
+
+
+size_t match_mask(const uint32_t* keys, size_t size, mask_key_s mk, uint32_t* out_idx) noexcept
+{
+    static const match_mask_f kernel = get_match_mask(best_isa());
+    return kernel(keys, size, mk, out_idx);
+}
+
+
+size_t match_any_byte(const uint32_t* keys, size_t size, uint8_t byte, uint32_t* out_idx) noexcept
+{
+    static const match_any_byte_f kernel = get_match_any_byte(best_isa());
+    return kernel(keys, size, byte, out_idx);
+}
+
+
+
+void filter(IpV4_c* first, size_t size, mask_key_s mk, filtered_ip_pool_t& out)
+{
+    collect(first, size, out, [mk](const uint32_t* keys, size_t n, uint32_t* idx)
+    {
+        return match_mask(keys, n, mk, idx);
+    });
+}
+
+
+void filter_any(IpV4_c* first, size_t size, uint8_t byte, filtered_ip_pool_t& out)
+{
+    collect(first, size, out, [byte](const uint32_t* keys, size_t n, uint32_t* idx)
+    {
+        return match_any_byte(keys, n, byte, idx);
+    });
+}
+
+} // namespace kernels
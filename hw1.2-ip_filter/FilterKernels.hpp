@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "IpV4_c.hpp"
+#include "IpPoolView_c.hpp"
+
+
+
+// Vectorized scans over packed keys of an ip pool. Every kernel writes the
+// indices (relative to `keys`) of the matched keys to `out_idx`, which must
+// have room for `size` elements, and returns the number of written indices.
+namespace kernels {
+
+enum class isa_e
+{
+    SCALAR,
+    SSE2,
+    AVX2,
+};
+
+// The best instruction set supported by the current CPU.
+isa_e best_isa() noexcept;
+bool is_supported(isa_e) noexcept;
+
+
+// IpV4_c::mask_t compiled to a pair: a key matches if (key & bitmask) == value.
+struct mask_key_s
+{
+    uint32_t    value   = 0;
+    uint32_t    bitmask = 0;
+
+    bool match(uint32_t key) const noexcept { return (key & bitmask) == value; }
+};
+
+mask_key_s make_mask_key(const IpV4_c::mask_t&) noexcept;
+
+
+size_t match_mask(isa_e, const uint32_t* keys, size_t size, mask_key_s, uint32_t* out_idx) noexcept;
+size_t match_any_byte(isa_e, const uint32_t* keys, size_t size, uint8_t, uint32_t* out_idx) noexcept;
+
+// The same with the best instruction set (chosen once at runtime).
+size_t match_mask(const uint32_t* keys, size_t size, mask_key_s, uint32_t* out_idx) noexcept;
+size_t match_any_byte(const uint32_t* keys, size_t size, uint8_t, uint32_t* out_idx) noexcept;
+
+
+inline const uint32_t* keys_of(const IpV4_c* ips) noexcept
+{
+    return reinterpret_cast<const uint32_t*>(ips);
+}
+
+
+// Append the matched elements of [first, first + size) to `out`, which has
+// to be a view of the pool containing the range.
+void filter(IpV4_c* first, size_t size, mask_key_s, filtered_ip_pool_t& out);
+void filter_any(IpV4_c* first, size_t size, uint8_t, filtered_ip_pool_t& out);
+
+} // namespace kernels
@@ -0,0 +1,148 @@
+#include "IpCounter_c.hpp"
+
+#include <algorithm>
+#include <stdexcept>  // std::overflow_error
+
+#include "IpWriter_c.hpp"
+
+
+
+IpCounter_c::IpCounter_c(size_t expected_unique)
+{
+    size_t capacity = 16;
+    while (capacity < 2 * expected_unique) { capacity *= 2; }
+    rehash(capacity);
+}
+
+
+
+void IpCounter_c::add(IpV4_c ip, uint32_t hits)
+{
+    if (hits == 0) { return; }
+    slot_s* slot = &m_slots[find(ip.key())];
+    if (slot->count == 0)
+    {
+        if (2 * (m_size + 1) > m_slots.size())
+        {
+            rehash(2 * m_slots.size());
+            slot = &m_slots[find(ip.key())];
+        }
+        slot->key = ip.key();
+        ++m_size;
+    }
+    if (slot->count > UINT32_MAX - hits)
+    {
+        throw std::overflow_error("IpCounter_c::add: too many hits of [" + ip.toString() + "]");
+    }
+    slot->count += hits;
+}
+
+
+
+void IpCounter_c::merge(const IpCounter_c& other)
+{
+    for (const slot_s& slot : other.m_slots)
+    {
+        if (slot.count != 0) { add(IpV4_c::from_key(slot.key), slot.count); }
+    }
+}
+
+
+
+uint64_t IpCounter_c::hits() const noexcept
+{
+    uint64_t hits = 0;
+    for (const slot_s& slot : m_slots) { hits += slot.count; }
+    return hits;
+}
+
+
+
+uint32_t IpCounter_c::count(IpV4_c ip) const noexcept
+{
+    return m_slots[find(ip.key())].count;
+}
+
+
+
+std::vector<IpCount_s> IpCounter_c::counts() const
+{
+    std::vector<IpCount_s> counts;
+    counts.reserve(m_size);
+    for (const slot_s& slot : m_slots)
+    {
+        if (slot.count != 0) { counts.push_back({IpV4_c::from_key(slot.key), slot.count}); }
+    }
+    return counts;
+}
+
+
+
+size_t IpCounter_c::find(uint32_t key) const noexcept
+{
+    //NOTE: the load factor is at most 1/2, so there is always an empty slot
+    const size_t mask = m_slots.size() - 1;
+    for (size_t i = home(key); ; i = (i + 1) & mask)
+    {
+        const slot_s& slot = m_slots[i];
+        if (slot.count == 0 || slot.key == key) { return i; }
+    }
+}
+
+
+
+void IpCounter_c::rehash(size_t capacity)
+{
+    std::vector<slot_s> slots(capacity);
+    slots.swap(m_slots);
+    m_shift = 32 - __builtin_ctzll(capacity);
+    for (const slot_s& slot : slots)
+    {
+        if (slot.count != 0) { m_slots[find(slot.key)] = slot; }
+    }
+}
+
+
+
+namespace utils {
+
+void sort(std::vector<IpCount_s>& counts, sort_order_e order)
+{
+    if (order == sort_order_e::ASC)
+    {
+        std::sort(counts.begin(), counts.end(),
+                  [](const IpCount_s& l, const IpCount_s& r) { return l.ip < r.ip; });
+    }
+    else
+    {
+        std::sort(counts.begin(), counts.end(),
+                  [](const IpCount_s& l, const IpCount_s& r) { return r.ip < l.ip; });
+    }
+}
+
+
+
+void top_k(std::vector<IpCount_s>& counts, size_t k)
+{
+    k = std::min(k, counts.size());
+    std::partial_sort(counts.begin(), counts.begin() + k, counts.end(),
+                      [](const IpCount_s& l, const IpCount_s& r)
+                      {
+                          return (l.count != r.count) ? l.count > r.count : r.ip < l.ip;
+                      });
+    counts.resize(k);
+}
+
+
+
+void print(const std::vector<IpCount_s>& counts, IpWriter_c& out)
+{
+    for (const IpCount_s& c : counts)
+    {
+        out.write(c.ip, '\t');
+        out.write_number(c.count);
+        out.write('\n');
+    }
+}
+
+} // namespace utils
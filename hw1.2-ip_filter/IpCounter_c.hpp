@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+
+#include "IpV4_c.hpp"
+#include "IpPoolSort.hpp"
+
+
+
+struct IpCount_s
+{
+    IpV4_c      ip;
+    uint32_t    count = 0;
+};
+
+
+
+// Hit counts of addresses: an open-addressing (linear probing) hash map
+// keyed by the packed address. Takes 8 bytes per slot and keeps the load
+// factor at most 1/2, so the memory depends on the unique addresses only.
+class IpCounter_c
+{
+public:
+    explicit IpCounter_c(size_t expected_unique = 0);
+
+    // Throws std::overflow_error if the count of the address overflows.
+    void add(IpV4_c ip, uint32_t hits = 1);
+    void merge(const IpCounter_c&);
+
+    // The number of unique addresses.
+    size_t size() const noexcept { return m_size; }
+    // The number of all added hits. O(capacity).
+    uint64_t hits() const noexcept;
+    // The number of hits of `ip` (0 if it wasn't added).
+    uint32_t count(IpV4_c ip) const noexcept;
+
+    // Unique addresses with their counts in an unspecified order.
+    std::vector<IpCount_s> counts() const;
+
+private:
+    // An empty slot has zero count.
+    struct slot_s
+    {
+        uint32_t    key   = 0;
+        uint32_t    count = 0;
+    };
+
+    size_t home(uint32_t key) const noexcept
+    {
+        //NOTE: Fibonacci hashing: the high bits of the product are well mixed
+        return static_cast<uint32_t>(key * 0x9E3779B1u) >> m_shift;
+    }
+    // The index of the slot of `key` or of the empty slot to insert it.
+    size_t find(uint32_t key) const noexcept;
+    void rehash(size_t capacity);
+
+    std::vector<slot_s>    m_slots;
+    size_t                 m_size  = 0;
+    unsigned               m_shift = 0;
+};
+
+
+
+class IpWriter_c;
+
+namespace utils {
+
+void sort(std::vector<IpCount_s>&, sort_order_e);
+// Keeps `k` most frequent addresses sorted by count, the ties are ordered by
+// the address descending.
+void top_k(std::vector<IpCount_s>&, size_t k);
+
+// Writes "address\tcount" lines.
+void print(const std::vector<IpCount_s>&, IpWriter_c&);
+
+} // namespace utils
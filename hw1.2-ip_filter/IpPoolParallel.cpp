@@ -0,0 +1,268 @@
+#include "IpPoolParallel.hpp"
+
+#include <algorithm>
+#include <future>
+#include <stdexcept>  // std::runtime_error
+#include <string>
+#include <vector>
+
+#include "IpPoolReader.hpp"
+#include "FilterKernels.hpp"
+
+
+
+namespace {
+
+// Calls `task(i)` for every i in [0, tasks_num): the first task runs in the
+// current thread, others in their own threads. Rethrows the first exception.
+template <typename F>
+void run_parallel(size_t tasks_num, F&& task)
+{
+    std::vector<std::future<void>> futures;
+    futures.reserve(tasks_num);
+    for (size_t i = 1; i < tasks_num; ++i)
+    {
+        futures.emplace_back(std::async(std::launch::async, [&task, i] { task(i); }));
+    }
+    if (tasks_num != 0) { task(0); }
+    for (auto& f : futures) { f.get(); }
+}
+
+
+// Bounds of the i-th part when [0, size) is split into `parts` parts.
+size_t part_begin(size_t size, size_t parts, size_t i) noexcept
+{
+    return size / parts * i + std::min(i, size % parts);
+}
+
+
+template <typename T>
+std::vector<T> concat(const std::vector<std::vector<T>>& parts)
+{
+    std::vector<size_t> offsets(parts.size() + 1, 0);
+    for (size_t i = 0; i < parts.size(); ++i) { offsets[i + 1] = offsets[i] + parts[i].size(); }
+    std::vector<T> result(offsets.back());
+    run_parallel(parts.size(), [&](size_t i)
+    {
+        std::copy(parts[i].cbegin(), parts[i].cend(), result.begin() + offsets[i]);
+    });
+    return result;
+}
+
+
+// Reads about BLOCK_SIZE bytes of `stream` ended by '\n' into `block`
+// after the `tail` of the previous block, and leaves the rest of the last
+// line in `tail`. Returns false at the end of the stream: then `block` is
+// the rest of the stream.
+bool read_lines(FILE* stream, std::string& block, std::string& tail, size_t& bytes_read)
+{
+    constexpr size_t BLOCK_SIZE = 1 << 20;
+    block.swap(tail);
+    tail.clear();
+    for (;;)
+    {
+        const size_t size = block.size();
+        block.resize(size + BLOCK_SIZE);
+        const size_t read = fread(block.data() + size, 1, BLOCK_SIZE, stream);
+        block.resize(size + read);
+        bytes_read += read;
+        if (read == 0)
+        {
+            if (ferror(stream)) { throw std::runtime_error("Can't read input stream"); }
+            return false;
+        }
+        //NOTE: a line longer than the block makes it grow
+        const size_t eol = block.rfind('\n');
+        if (eol != std::string::npos)
+        {
+            tail.assign(block, eol + 1);
+            block.resize(eol + 1);
+            return true;
+        }
+    }
+}
+
+
+// The views of the parts joined to a view of the whole pool.
+filtered_ip_pool_t concat(ip_pool_t& ip_pool, const std::vector<filtered_ip_pool_t>& parts)
+{
+    filtered_ip_pool_t result {ip_pool};
+    for (const filtered_ip_pool_t& part : parts) { result.append(part); }
+    return result;
+}
+
+
+// `filter(first, size, out)` appends matched elements of a part to `out`.
+template <typename Filter>
+filtered_ip_pool_t parallel_collect(ip_pool_t& ip_pool, size_t threads, Filter filter)
+{
+    threads = std::max<size_t>(1, std::min(threads, ip_pool.size()));
+    std::vector<filtered_ip_pool_t> parts(threads);
+    run_parallel(threads, [&](size_t i)
+    {
+        const size_t begin = part_begin(ip_pool.size(), threads, i);
+        const size_t end   = part_begin(ip_pool.size(), threads, i + 1);
+        //NOTE: a dense view of the whole pool would take a pool-sized bitmap per part
+        parts[i] = filtered_ip_pool_t{ip_pool.data() + begin, end - begin};
+        filter(ip_pool.data() + begin, end - begin, parts[i]);
+    });
+    return concat(ip_pool, parts);
+}
+
+} // namespace
+
+
+
+namespace utils {
+
+ip_pool_t make_ip_pool(std::string_view text, size_t threads)
+{
+    threads = std::max<size_t>(1, threads);
+    std::vector<std::string_view> chunks;
+    chunks.reserve(threads);
+    size_t begin = 0;
+    for (size_t i = 1; i <= threads && begin != text.size(); ++i)
+    {
+        size_t end = std::max(begin, part_begin(text.size(), threads, i));
+        if (end != text.size())
+        {
+            end = text.find('\n', end);
+            end = (end == std::string_view::npos) ? text.size() : end + 1;
+        }
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+
+    std::vector<ip_pool_t> pools(chunks.size());
+    run_parallel(chunks.size(), [&](size_t i)
+    {
+        for_each_first_column_eof(chunks[i], [&pool = pools[i]](std::string_view column)
+        {
+            pool.emplace_back(column);
+        });
+    });
+    return concat(pools);
+}
+
+
+
+ip_pool_t make_ip_pool(FILE* stream, size_t threads, size_t* bytes_read)
+{
+    threads = std::max<size_t>(1, threads);
+    std::vector<std::string> blocks(threads);
+    std::string              tail;
+    std::vector<ip_pool_t>   pools;
+    size_t                   read = 0;
+    for (bool more = true; more; )
+    {
+        size_t n = 0;
+        while (n < threads && more) { more = read_lines(stream, blocks[n++], tail, read); }
+
+        const size_t first = pools.size();
+        pools.resize(first + n);
+        run_parallel(n, [&](size_t i)
+        {
+            ip_pool_t& pool = pools[first + i];
+            pool.reserve(count_lines(blocks[i]));
+            for_each_first_column_eof(blocks[i], [&pool](std::string_view column)
+            {
+                pool.emplace_back(column);
+            });
+        });
+    }
+    if (bytes_read) { *bytes_read = read; }
+    return concat(pools);
+}
+
+
+
+void parallel_sort(ip_pool_t& ip_pool, sort_order_e order, size_t threads)
+{
+    const size_t size = ip_pool.size();
+    threads = std::max<size_t>(1, std::min(threads, size));
+    ip_pool_t scratch(size);
+
+    std::vector<size_t> bounds(threads + 1);
+    for (size_t i = 0; i <= threads; ++i) { bounds[i] = part_begin(size, threads, i); }
+    run_parallel(threads, [&](size_t i)
+    {
+        radix_sort(ip_pool.data() + bounds[i], bounds[i + 1] - bounds[i],
+                   scratch.data() + bounds[i], order);
+    });
+
+    //NOTE: merge neighbour parts pairwise until the only part is left
+    IpV4_c* src = ip_pool.data();
+    IpV4_c* dst = scratch.data();
+    while (bounds.size() > 2)
+    {
+        const size_t parts = bounds.size() - 1;
+        run_parallel((parts + 1) / 2, [&](size_t pair)
+        {
+            const size_t b = bounds[2 * pair];
+            const size_t m = bounds[std::min(2 * pair + 1, parts)];
+            const size_t e = bounds[std::min(2 * pair + 2, parts)];
+            if (order == sort_order_e::ASC)
+            {
+                std::merge(src + b, src + m, src + m, src + e, dst + b);
+            }
+            else
+            {
+                std::merge(src + b, src + m, src + m, src + e, dst + b,
+                           [](const IpV4_c& l, const IpV4_c& r) { return r < l; });
+            }
+        });
+        std::vector<size_t> merged_bounds;
+        for (size_t i = 0; i < bounds.size(); i += 2) { merged_bounds.push_back(bounds[i]); }
+        if (merged_bounds.back() != size) { merged_bounds.push_back(size); }
+        bounds.swap(merged_bounds);
+        std::swap(src, dst);
+    }
+    if (src != ip_pool.data()) { ip_pool.swap(scratch); }
+}
+
+
+
+filtered_ip_pool_t parallel_filter(ip_pool_t& ip_pool, const IpV4_c::mask_t& mask, size_t threads)
+{
+    const kernels::mask_key_s mk = kernels::make_mask_key(mask);
+    return parallel_collect(ip_pool, threads, [mk](IpV4_c* first, size_t size, filtered_ip_pool_t& out)
+    {
+        kernels::filter(first, size, mk, out);
+    });
+}
+
+
+
+filtered_ip_pool_t parallel_filter_any(ip_pool_t& ip_pool, uint8_t byte, size_t threads)
+{
+    return parallel_collect(ip_pool, threads, [byte](IpV4_c* first, size_t size, filtered_ip_pool_t& out)
+    {
+        kernels::filter_any(first, size, byte, out);
+    });
+}
+
+
+
+QueryBatch_c::results_t parallel_run(const QueryBatch_c& queries, ip_pool_t& ip_pool, size_t threads)
+{
+    threads = std::max<size_t>(1, std::min(threads, ip_pool.size()));
+    std::vector<QueryBatch_c::results_t> parts(threads);
+    run_parallel(threads, [&](size_t i)
+    {
+        const size_t begin = part_begin(ip_pool.size(), threads, i);
+        const size_t end   = part_begin(ip_pool.size(), threads, i + 1);
+        parts[i].assign(queries.size(), filtered_ip_pool_t{ip_pool.data() + begin, end - begin});
+        queries.run(ip_pool, begin, end, parts[i]);
+    });
+
+    QueryBatch_c::results_t results(queries.size());
+    for (size_t q = 0; q < queries.size(); ++q)
+    {
+        std::vector<filtered_ip_pool_t> query_parts(threads);
+        for (size_t i = 0; i < threads; ++i) { query_parts[i] = std::move(parts[i][q]); }
+        results[q] = concat(ip_pool, query_parts);
+    }
+    return results;
+}
+
+} // namespace utils
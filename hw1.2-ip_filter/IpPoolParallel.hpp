@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string_view>
+#include <cstdio>
+
+#include "IpV4_c.hpp"
+#include "IpPoolView_c.hpp"
+#include "IpPoolSort.hpp"
+#include "QueryBatch_c.hpp"
+
+
+
+// Multi-threaded versions of the ip_filter stages. Every function gives
+// exactly the same result (including the order) as its sequential version.
+namespace utils {
+
+// Parses `text` split by lines into `threads` chunks.
+ip_pool_t make_ip_pool(std::string_view text, size_t threads);
+// Reads `stream` by batches of `threads` blocks of whole lines and parses
+// the blocks of a batch in parallel, so only a batch of the text is kept in
+// memory. `bytes_read` is the size of the read input if it isn't null.
+ip_pool_t make_ip_pool(FILE* stream, size_t threads, size_t* bytes_read = nullptr);
+
+// Radix sorts `threads` parts of the pool and merges them pairwise.
+void parallel_sort(ip_pool_t&, sort_order_e, size_t threads);
+
+// Scans `threads` parts of the pool and concatenates the partial results.
+filtered_ip_pool_t parallel_filter(ip_pool_t&, const IpV4_c::mask_t&, size_t threads);
+filtered_ip_pool_t parallel_filter_any(ip_pool_t&, uint8_t, size_t threads);
+QueryBatch_c::results_t parallel_run(const QueryBatch_c&, ip_pool_t&, size_t threads);
+
+} // namespace utils
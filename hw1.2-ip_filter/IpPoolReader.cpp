@@ -0,0 +1,163 @@
+#include "IpPoolReader.hpp"
+#include "ChunkedIpPool_c.hpp"
+
+#include <algorithm>     // std::copy
+#include <memory>
+#include <stdexcept>     // std::runtime_error
+#include <system_error>  // std::system_error
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+
+MappedFile_c::MappedFile_c(const char* path)
+{
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                std::string("Can't open file [") + path + "]");
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0)
+    {
+        int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::generic_category(),
+                                std::string("Can't stat file [") + path + "]");
+    }
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size != 0)
+    {
+        void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(),
+                                    std::string("Can't mmap file [") + path + "]");
+        }
+        ::madvise(data, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const char*>(data);
+    }
+    ::close(fd);
+}
+
+
+MappedFile_c::~MappedFile_c()
+{
+    if (m_data) { ::munmap(const_cast<char*>(m_data), m_size); }
+}
+
+
+
+
+namespace utils {
+
+namespace {
+
+// Reads what is available (at least one byte) like read(2) does for a pipe
+// or `size` bytes like fread does for a stream without a file descriptor.
+// Returns 0 at the end of the stream.
+size_t read_some(FILE* stream, char* buf, size_t size)
+{
+    const int fd = fileno(stream);
+    if (fd < 0)
+    {
+        const size_t read = fread(buf, 1, size, stream);
+        if (read == 0 && ferror(stream)) { throw std::runtime_error("Can't read input stream"); }
+        return read;
+    }
+    for (;;)
+    {
+        const ssize_t read = ::read(fd, buf, size);
+        if (read >= 0)      { return static_cast<size_t>(read); }
+        if (errno != EINTR) { throw std::system_error(errno, std::generic_category(), "Can't read input stream"); }
+    }
+}
+
+} // namespace
+
+
+
+size_t read_first_columns(FILE* stream, void (*on_column)(std::string_view, void*), void* ctx)
+{
+    constexpr size_t INIT_BLOCK_SIZE = 1 << 20;
+    size_t                  capacity = INIT_BLOCK_SIZE;
+    std::unique_ptr<char[]> block {new char[capacity]};
+    size_t                  size     = 0;
+    size_t                  total    = 0;
+    auto call = [on_column, ctx](std::string_view column) { on_column(column, ctx); };
+
+    for (;;)
+    {
+        if (size == capacity)
+        {
+            //NOTE: the line is longer than the block
+            std::unique_ptr<char[]> bigger {new char[capacity * 2]};
+            std::copy(block.get(), block.get() + size, bigger.get());
+            block.swap(bigger);
+            capacity *= 2;
+        }
+        //NOTE: the lines are passed on as soon as they are read, so the
+        //      columns of a pipe come without waiting for the whole block
+        const size_t read = read_some(stream, block.get() + size, capacity - size);
+        if (read == 0) { break; }
+        size  += read;
+        total += read;
+        size_t consumed = for_each_first_column({block.get(), size}, call);
+        std::copy(block.get() + consumed, block.get() + size, block.get());
+        size -= consumed;
+    }
+    for_each_first_column_eof({block.get(), size}, call);
+    return total;
+}
+
+
+
+ip_pool_t make_ip_pool(std::string_view text)
+{
+    //NOTE: the text is in memory, so the lines are counted to allocate the
+    //      pool once instead of growing it by reallocations
+    ip_pool_t ip_pool;
+    ip_pool.reserve(count_lines(text));
+    for_each_first_column_eof(text, [&ip_pool](std::string_view column)
+    {
+        ip_pool.emplace_back(column);
+    });
+    return ip_pool;
+}
+
+
+
+ip_pool_t make_ip_pool(FILE* stream, size_t* bytes_read)
+{
+    //NOTE: the size is unknown, the chunks grow without copies
+    ChunkedIpPool_c chunked_pool;
+    const size_t read = read_first_columns(stream, [&chunked_pool](std::string_view column)
+    {
+        chunked_pool.emplace_back(column);
+    });
+    if (bytes_read) { *bytes_read = read; }
+    return chunked_pool.release();
+}
+
+
+
+size_t count_lines(std::string_view text) noexcept
+{
+    size_t lines = 0;
+    for (const char* it = text.data(), * const end = it + text.size(); it != end; ++lines)
+    {
+        const void* eol = memchr(it, '\n', end - it);
+        it = eol ? static_cast<const char*>(eol) + 1 : end;
+    }
+    return lines;
+}
+
+} // namespace utils
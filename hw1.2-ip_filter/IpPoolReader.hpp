@@ -0,0 +1,104 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <cstdio>
+
+#include "IpV4_c.hpp"
+#include "utils.hpp"
+
+
+
+// Read-only memory mapping of the whole file.
+class MappedFile_c
+{
+public:
+    explicit MappedFile_c(const char* path);
+    ~MappedFile_c();
+    MappedFile_c(const MappedFile_c&)            = delete;
+    MappedFile_c& operator=(const MappedFile_c&) = delete;
+
+    std::string_view view() const noexcept { return {m_data, m_size}; }
+
+private:
+    const char*    m_data = nullptr;
+    size_t         m_size = 0;
+};
+
+
+
+namespace utils {
+
+// The first tab-separated column of a line without '\n'.
+inline std::string_view first_column(std::string_view line) noexcept
+{
+    std::string_view column = split_view(line, '\t').front();
+    //NOTE: the last column may be ended by "\r\n"
+    if (column.size() == line.size() && not column.empty() && column.back() == '\r')
+    {
+        column.remove_suffix(1);
+    }
+    return column;
+}
+
+
+// Calls `on_column(std::string_view)` with the first tab-separated column of
+// every complete (ended by '\n') line of `buf`. Returns the number of
+// consumed bytes, i.e. the offset right after the last '\n'.
+template <typename F>
+size_t for_each_first_column(std::string_view buf, F&& on_column)
+{
+    //NOTE: an empty view may have no data, then split_view has another one
+    if (buf.empty()) { return 0; }
+    const char* const end      = buf.data() + buf.size();
+    size_t            consumed = 0;
+    for (std::string_view line : split_view(buf, '\n'))
+    {
+        //NOTE: the last field isn't ended by '\n'
+        if (line.data() + line.size() == end) { break; }
+        on_column(first_column(line));
+        consumed = line.data() + line.size() + 1 - buf.data();
+    }
+    return consumed;
+}
+
+
+// The same as `for_each_first_column` but the last line may be unterminated.
+template <typename F>
+void for_each_first_column_eof(std::string_view buf, F&& on_column)
+{
+    size_t consumed = for_each_first_column(buf, on_column);
+    if (consumed != buf.size())
+    {
+        on_column(first_column(buf.substr(consumed)));
+    }
+}
+
+
+// Reads `stream` by big blocks and calls `on_column` like
+// `for_each_first_column_eof` does for the whole content. Returns the number
+// of bytes read. A stream with a file descriptor is read by read(2), so it
+// must not have buffered input, and the lines of a pipe are passed on as
+// soon as they come.
+size_t read_first_columns(FILE* stream, void (*on_column)(std::string_view, void*), void* ctx);
+
+template <typename F>
+size_t read_first_columns(FILE* stream, F&& on_column)
+{
+    using func_t = std::remove_reference_t<F>;
+    return read_first_columns(
+        stream,
+        [](std::string_view column, void* ctx) { (*static_cast<func_t*>(ctx))(column); },
+        &on_column);
+}
+
+
+ip_pool_t make_ip_pool(std::string_view text);
+// `bytes_read` is the size of the read input if it isn't null.
+ip_pool_t make_ip_pool(FILE* stream, size_t* bytes_read = nullptr);
+
+// The number of lines including the unterminated last one.
+size_t count_lines(std::string_view text) noexcept;
+
+} // namespace utils
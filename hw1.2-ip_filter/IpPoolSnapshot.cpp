@@ -0,0 +1,196 @@
+#include "IpPoolSnapshot.hpp"
+
+#include <algorithm>     // std::is_sorted
+#include <cstdio>
+#include <cstring>       // std::memcpy
+#include <memory>
+#include <stdexcept>     // std::runtime_error
+#include <string>
+#include <system_error>  // std::system_error
+
+#include <cerrno>
+
+#include "IpPoolReader.hpp"
+
+
+
+namespace utils {
+
+namespace {
+
+//NOTE: a uint32_t takes at most 5 bytes of 7 bits
+constexpr size_t MAX_VARINT_LEN = 5;
+
+struct file_closer_s
+{
+    void operator()(FILE* file) const noexcept { std::fclose(file); }
+};
+
+void write_all(FILE* file, const void* data, size_t size, const char* path)
+{
+    //NOTE: the data of an empty pool may be null
+    if (size == 0) { return; }
+    if (std::fwrite(data, 1, size, file) != size)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                std::string("Can't write file [") + path + "]");
+    }
+}
+
+
+[[noreturn]] void throw_invalid(const char* path, const char* reason)
+{
+    throw std::runtime_error(std::string("Invalid snapshot [") + path + "]: " + reason);
+}
+
+
+// Keys of a sorted pool in the ascending order: the descending pool is
+// stored inverted.
+std::vector<uint8_t> encode_delta_varint(const ip_pool_t& ip_pool, uint32_t inversion)
+{
+    std::vector<uint8_t> payload(ip_pool.size() * MAX_VARINT_LEN);
+    uint8_t* out  = payload.data();
+    uint32_t prev = 0;
+    for (const IpV4_c& ip : ip_pool)
+    {
+        const uint32_t key = ip.key() ^ inversion;
+        uint32_t delta = key - prev;
+        prev = key;
+        for (; delta >= 0x80; delta >>= 7) { *out++ = static_cast<uint8_t>(delta | 0x80); }
+        *out++ = static_cast<uint8_t>(delta);
+    }
+    payload.resize(out - payload.data());
+    return payload;
+}
+
+
+void decode_delta_varint(const uint8_t* in, const uint8_t* end, uint32_t inversion,
+                         ip_pool_t& ip_pool, const char* path)
+{
+    uint32_t prev = 0;
+    for (IpV4_c& ip : ip_pool)
+    {
+        uint32_t delta = 0;
+        for (unsigned shift = 0; ; shift += 7)
+        {
+            if (in == end || shift >= 7 * MAX_VARINT_LEN) { throw_invalid(path, "broken varint"); }
+            const uint8_t byte = *in++;
+            //NOTE: the last byte keeps the 4 high bits of a uint32_t only
+            if (shift == 7 * (MAX_VARINT_LEN - 1) && byte > 0x0F) { throw_invalid(path, "broken varint"); }
+            delta |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) { break; }
+        }
+        //NOTE: a wrapped key would break the order of the pool
+        if (delta > UINT32_MAX - prev) { throw_invalid(path, "broken varint"); }
+        prev += delta;
+        ip = IpV4_c::from_key(prev ^ inversion);
+    }
+    if (in != end) { throw_invalid(path, "extra payload"); }
+}
+
+} // namespace
+
+
+
+snapshot_info_s save_ip_pool(const ip_pool_t& ip_pool, const char* path, bool compress)
+{
+    snapshot_info_s info;
+    if (std::is_sorted(ip_pool.cbegin(), ip_pool.cend()))
+    {
+        info.sorted = true;
+    }
+    else if (std::is_sorted(ip_pool.cbegin(), ip_pool.cend(),
+                            [](const IpV4_c& l, const IpV4_c& r) { return r < l; }))
+    {
+        info.sorted = true;
+        info.order  = sort_order_e::DESC;
+    }
+    info.compressed = compress && info.sorted;
+
+    snapshot_header_s header;
+    header.count = ip_pool.size();
+    if (info.sorted)                      { header.flags |= SNAPSHOT_SORTED; }
+    if (info.order == sort_order_e::DESC) { header.flags |= SNAPSHOT_DESC; }
+
+    std::vector<uint8_t> payload;
+    const void* data = ip_pool.data();
+    header.payload_size = ip_pool.size() * sizeof(uint32_t);
+    if (info.compressed)
+    {
+        header.flags |= SNAPSHOT_DELTA_VARINT;
+        payload = encode_delta_varint(ip_pool, (info.order == sort_order_e::DESC) ? UINT32_MAX : 0);
+        data = payload.data();
+        header.payload_size = payload.size();
+    }
+
+    std::unique_ptr<FILE, file_closer_s> file {std::fopen(path, "wb")};
+    if (not file)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                std::string("Can't create file [") + path + "]");
+    }
+    write_all(file.get(), &header, sizeof(header), path);
+    write_all(file.get(), data, header.payload_size, path);
+    info.file_size = sizeof(header) + header.payload_size;
+    if (std::fclose(file.release()) != 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                std::string("Can't write file [") + path + "]");
+    }
+    return info;
+}
+
+
+
+ip_pool_t load_ip_pool(const char* path, snapshot_info_s* info)
+{
+    MappedFile_c file {path};
+    const std::string_view data = file.view();
+
+    snapshot_header_s header;
+    if (data.size() < sizeof(header)) { throw_invalid(path, "too short"); }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != SNAPSHOT_MAGIC)     { throw_invalid(path, "wrong magic"); }
+    if (header.version != SNAPSHOT_VERSION) { throw_invalid(path, "unsupported version"); }
+    if (header.payload_size != data.size() - sizeof(header)) { throw_invalid(path, "wrong size"); }
+
+    const bool compressed = header.flags & SNAPSHOT_DELTA_VARINT;
+    const bool sorted     = header.flags & SNAPSHOT_SORTED;
+    const sort_order_e order = (header.flags & SNAPSHOT_DESC) ? sort_order_e::DESC : sort_order_e::ASC;
+    if (compressed && not sorted) { throw_invalid(path, "compressed unsorted pool"); }
+    //NOTE: a varint takes one byte at least; the raw size is checked by
+    //      division since `count * sizeof(uint32_t)` may overflow
+    if (compressed ? header.count > header.payload_size
+                   : header.payload_size % sizeof(uint32_t) != 0
+                     || header.count != header.payload_size / sizeof(uint32_t))
+    {
+        throw_invalid(path, "wrong size");
+    }
+
+    ip_pool_t ip_pool(header.count);
+    const char* payload = data.data() + sizeof(header);
+    if (compressed)
+    {
+        const uint8_t* in = reinterpret_cast<const uint8_t*>(payload);
+        decode_delta_varint(in, in + header.payload_size,
+                            (order == sort_order_e::DESC) ? UINT32_MAX : 0, ip_pool, path);
+    }
+    else if (header.payload_size != 0)
+    {
+        //NOTE: IpV4_c is a packed key, so the keys are copied as is
+        std::memcpy(ip_pool.data(), payload, header.payload_size);
+        //NOTE: the index built on a sorted snapshot relies on the flag
+        if (sorted && not ((order == sort_order_e::DESC)
+                           ? std::is_sorted(ip_pool.cbegin(), ip_pool.cend(),
+                                            [](const IpV4_c& l, const IpV4_c& r) { return r < l; })
+                           : std::is_sorted(ip_pool.cbegin(), ip_pool.cend())))
+        {
+            throw_invalid(path, "not sorted");
+        }
+    }
+
+    if (info) { *info = snapshot_info_s{sorted, order, compressed, data.size()}; }
+    return ip_pool;
+}
+
+} // namespace utils
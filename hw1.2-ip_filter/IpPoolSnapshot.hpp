@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+
+#include "IpV4_c.hpp"
+#include "IpPoolSort.hpp"
+
+
+
+// A binary snapshot of an ip pool: snapshot_header_s followed by the keys,
+// either raw (uint32_t in the native byte order) or, for a sorted pool,
+// delta-encoded and compressed by LEB128 varints.
+namespace utils {
+
+constexpr uint32_t SNAPSHOT_MAGIC   = 0x50495049;  // "IPIP"
+constexpr uint16_t SNAPSHOT_VERSION = 1;
+
+enum snapshot_flags_e : uint16_t
+{
+    SNAPSHOT_SORTED       = 1 << 0,
+    SNAPSHOT_DESC         = 1 << 1,
+    SNAPSHOT_DELTA_VARINT = 1 << 2,
+};
+
+struct snapshot_header_s
+{
+    // SNAPSHOT_MAGIC in the native byte order, so a snapshot of a machine
+    // with another byte order is rejected
+    uint32_t    magic        = SNAPSHOT_MAGIC;
+    uint16_t    version      = SNAPSHOT_VERSION;
+    uint16_t    flags        = 0;
+    uint64_t    count        = 0;
+    uint64_t    payload_size = 0;
+};
+static_assert(sizeof(snapshot_header_s) == 24, "the layout of the file header");
+
+
+struct snapshot_info_s
+{
+    bool            sorted     = false;
+    sort_order_e    order      = sort_order_e::ASC;
+    bool            compressed = false;
+    // The size of the snapshot file in bytes.
+    size_t          file_size  = 0;
+};
+
+// Writes the snapshot to `path`. `compress` is ignored for an unsorted pool,
+// the returned info tells what was written. Throws std::system_error.
+snapshot_info_s save_ip_pool(const ip_pool_t&, const char* path, bool compress);
+// Loads the snapshot by mmap. Throws std::system_error if the file can't be
+// read and std::runtime_error if it isn't a valid snapshot.
+ip_pool_t load_ip_pool(const char* path, snapshot_info_s* info = nullptr);
+
+} // namespace utils
@@ -0,0 +1,92 @@
+#include "IpPoolSort.hpp"
+
+#include <array>
+#include <algorithm>  // std::copy
+#include <utility>    // std::exchange, std::swap
+
+
+
+namespace {
+
+// Returns the buffer (`src` or `dst`) which contains the sorted keys.
+template <typename Ip>
+Ip* radix_sort_impl(Ip* src, Ip* dst, size_t size, utils::sort_order_e order)
+{
+    using key_t = typename Ip::key_t;
+    constexpr size_t DIGIT_BITS = 8;
+    constexpr size_t BUCKETS    = 1 << DIGIT_BITS;
+    constexpr size_t PASSES     = sizeof(key_t) * 8 / DIGIT_BITS;
+    using histogram_t = std::array<std::array<size_t, BUCKETS>, PASSES>;
+
+    if (size < 2) { return src; }
+
+    //NOTE: the descending order is the ascending one of the inverted keys
+    const key_t inv = (order == utils::sort_order_e::DESC) ? ~key_t{0} : key_t{0};
+    auto digit = [inv](const Ip& ip, size_t pass) -> size_t
+    {
+        return static_cast<size_t>((ip.key() ^ inv) >> (pass * DIGIT_BITS)) & (BUCKETS - 1);
+    };
+
+    histogram_t hist {};
+    for (size_t i = 0; i < size; ++i)
+    {
+        for (size_t pass = 0; pass < PASSES; ++pass) { ++hist[pass][digit(src[i], pass)]; }
+    }
+
+    for (size_t pass = 0; pass < PASSES; ++pass)
+    {
+        std::array<size_t, BUCKETS>& offsets = hist[pass];
+        //NOTE: all keys have the same digit, nothing to do
+        if (offsets[digit(*src, pass)] == size) { continue; }
+
+        size_t sum = 0;
+        for (size_t& offset : offsets) { sum += std::exchange(offset, sum); }
+        for (size_t i = 0; i < size; ++i)
+        {
+            dst[offsets[digit(src[i], pass)]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+    return src;
+}
+
+} // namespace
+
+
+
+namespace utils {
+
+void radix_sort(ip_pool_t& ip_pool, ip_pool_t& scratch, sort_order_e order)
+{
+    scratch.resize(ip_pool.size());
+    IpV4_c* sorted = radix_sort_impl(ip_pool.data(), scratch.data(), ip_pool.size(), order);
+    if (sorted != ip_pool.data()) { ip_pool.swap(scratch); }
+}
+
+
+
+void radix_sort(ip_pool_t& ip_pool, sort_order_e order)
+{
+    ip_pool_t scratch;
+    radix_sort(ip_pool, scratch, order);
+}
+
+
+
+void radix_sort(IpV4_c* data, size_t size, IpV4_c* scratch, sort_order_e order)
+{
+    IpV4_c* sorted = radix_sort_impl(data, scratch, size, order);
+    if (sorted != data) { std::copy(sorted, sorted + size, data); }
+}
+
+
+
+
+void radix_sort(ip6_pool_t& ip_pool, sort_order_e order)
+{
+    ip6_pool_t scratch(ip_pool.size());
+    IpV6_c* sorted = radix_sort_impl(ip_pool.data(), scratch.data(), ip_pool.size(), order);
+    if (sorted != ip_pool.data()) { ip_pool.swap(scratch); }
+}
+
+} // namespace utils
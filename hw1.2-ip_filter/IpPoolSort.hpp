@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>  // std::partition_point
+#include <vector>
+
+#include "IpV4_c.hpp"
+#include "IpV6_c.hpp"
+
+
+
+namespace utils {
+
+enum class sort_order_e
+{
+    ASC,
+    DESC,
+};
+
+
+// LSD radix sort by 8-bit digits of IpV4_c::key(). `scratch` is resized to
+// the pool size and can be reused between calls to avoid allocations.
+void radix_sort(ip_pool_t&, ip_pool_t& scratch, sort_order_e = sort_order_e::ASC);
+void radix_sort(ip_pool_t&, sort_order_e = sort_order_e::ASC);
+// The same for a raw range; `scratch` must have room for `size` elements.
+void radix_sort(IpV4_c* data, size_t size, IpV4_c* scratch, sort_order_e = sort_order_e::ASC);
+// The same for 128-bit keys: the passes where all keys have the same digit
+// are skipped, so common prefixes are cheap.
+void radix_sort(ip6_pool_t&, sort_order_e = sort_order_e::ASC);
+
+
+// Addresses of a pool sorted in `order` which have the same first
+// `prefix_len` bits as `ip` (a CIDR prefix). O(log(pool size)).
+template <typename Ip>
+BasicIpSpan_c<Ip> prefix_range(std::vector<Ip>& ip_pool, sort_order_e order, Ip ip, unsigned prefix_len)
+{
+    using key_t = typename Ip::key_t;
+    constexpr unsigned KEY_BITS = sizeof(key_t) * 8;
+
+    Ip* const first = ip_pool.data();
+    Ip* const last  = first + ip_pool.size();
+    //NOTE: a shift by the whole width is UB, so /0 is handled separately
+    if (prefix_len == 0) { return {first, last}; }
+    const key_t host_bits = (prefix_len >= KEY_BITS) ? key_t{0} : ~key_t{0} >> prefix_len;
+    const key_t lo        = ip.key() & ~host_bits;
+    const key_t hi        = ip.key() | host_bits;
+    if (order == sort_order_e::ASC)
+    {
+        return {std::partition_point(first, last, [lo](const Ip& x) { return x.key() < lo; }),
+                std::partition_point(first, last, [hi](const Ip& x) { return x.key() <= hi; })};
+    }
+    return {std::partition_point(first, last, [hi](const Ip& x) { return x.key() > hi; }),
+            std::partition_point(first, last, [lo](const Ip& x) { return x.key() >= lo; })};
+}
+
+} // namespace utils
@@ -0,0 +1,155 @@
+#include "IpPoolView_c.hpp"
+
+#include <algorithm>
+#include <stdexcept>  // std::length_error
+
+#include "FilterKernels.hpp"
+#include "IpV6_c.hpp"
+#include "IpWriter_c.hpp"
+
+
+
+template <typename Ip>
+BasicIpPoolView_c<Ip>::BasicIpPoolView_c(Ip* base, size_t pool_size)
+    : m_base(base)
+    , m_pool_size(pool_size)
+{
+    if (pool_size > UINT32_MAX)
+    {
+        throw std::length_error("BasicIpPoolView_c: the pool is too big");
+    }
+}
+
+
+
+template <typename Ip>
+void BasicIpPoolView_c<Ip>::push_back(uint32_t index)
+{
+    ++m_size;
+    if (is_dense()) { set_bit(index); return; }
+    m_idx.push_back(index);
+    if (need_bitmap(m_idx.size())) { to_bitmap(); }
+}
+
+
+
+template <typename Ip>
+void BasicIpPoolView_c<Ip>::push_back(uint32_t offset, const uint32_t* indices, size_t n)
+{
+    m_size += n;
+    if (not is_dense() && need_bitmap(m_idx.size() + n)) { to_bitmap(); }
+    if (is_dense())
+    {
+        for (size_t i = 0; i < n; ++i) { set_bit(offset + indices[i]); }
+    }
+    else
+    {
+        for (size_t i = 0; i < n; ++i) { m_idx.push_back(offset + indices[i]); }
+    }
+}
+
+
+
+template <typename Ip>
+void BasicIpPoolView_c<Ip>::push_back_range(uint32_t first, uint32_t last)
+{
+    m_size += last - first;
+    if (not is_dense() && need_bitmap(m_idx.size() + (last - first))) { to_bitmap(); }
+    if (is_dense())
+    {
+        for (uint32_t i = first; i != last; ++i) { set_bit(i); }
+    }
+    else
+    {
+        for (uint32_t i = first; i != last; ++i) { m_idx.push_back(i); }
+    }
+}
+
+
+
+template <typename Ip>
+void BasicIpPoolView_c<Ip>::append(const BasicIpPoolView_c& other)
+{
+    for (Ip& ip : other) { push_back(static_cast<uint32_t>(&ip - m_base)); }
+}
+
+
+
+template <typename Ip>
+bool BasicIpPoolView_c<Ip>::operator==(const BasicIpPoolView_c& o) const noexcept
+{
+    return m_base == o.m_base && m_size == o.m_size
+        && std::equal(begin(), end(), o.begin(),
+                      [](const Ip& l, const Ip& r) { return &l == &r; });
+}
+
+
+
+template <typename Ip>
+size_t BasicIpPoolView_c<Ip>::next_pos(size_t pos) const noexcept
+{
+    if (not is_dense()) { return pos + 1; }
+    const size_t index = (pos == npos()) ? 0 : pos + 1;
+    if (index >= m_pool_size) { return m_pool_size; }
+    size_t   word = index / WORD_BITS;
+    uint64_t bits = m_bitmap[word] & (~uint64_t{0} << (index % WORD_BITS));
+    while (0 == bits)
+    {
+        if (++word == m_bitmap.size()) { return m_pool_size; }
+        bits = m_bitmap[word];
+    }
+    return word * WORD_BITS + __builtin_ctzll(bits);
+}
+
+
+
+template <typename Ip>
+void BasicIpPoolView_c<Ip>::to_bitmap()
+{
+    m_bitmap.assign((m_pool_size + WORD_BITS - 1) / WORD_BITS, 0);
+    for (uint32_t index : m_idx) { set_bit(index); }
+    std::vector<uint32_t>().swap(m_idx);
+}
+
+
+
+template class BasicIpPoolView_c<IpV4_c>;
+template class BasicIpPoolView_c<IpV6_c>;
+
+
+
+
+namespace utils {
+
+filtered_ip_pool_t filter(ip_pool_t& ip_pool, const IpV4_c::mask_t& mask)
+{
+    //NOTE: the view checks that the indices fit uint32_t
+    filtered_ip_pool_t f_pool {ip_pool};
+    if (std::all_of(mask.cbegin(), mask.cend(), [](int v){ return v == IpV4_c::MATCH_SKIP_BYTE; }))
+    {
+        f_pool.push_back_range(0, static_cast<uint32_t>(ip_pool.size()));
+    }
+    else
+    {
+        kernels::filter(ip_pool.data(), ip_pool.size(), kernels::make_mask_key(mask), f_pool);
+    }
+    return f_pool;
+}
+
+
+
+filtered_ip_pool_t filter_any(ip_pool_t& ip_pool, uint8_t byte)
+{
+    filtered_ip_pool_t f_pool {ip_pool};
+    kernels::filter_any(ip_pool.data(), ip_pool.size(), byte, f_pool);
+    return f_pool;
+}
+
+
+
+void print(const filtered_ip_pool_t& ip_pool)
+{
+    IpWriter_c out;
+    print(ip_pool, out);
+}
+} // namespace utils
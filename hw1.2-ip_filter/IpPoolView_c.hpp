@@ -0,0 +1,129 @@
+#pragma once
+
+#include <iterator>
+#include <vector>
+
+#include <cstdint>
+
+#include "IpV4_c.hpp"
+
+
+
+// Addresses of a pool of type Ip selected by a filter, in the order of the
+// pool. Keeps 32-bit indices while matches are sparse and switches to a
+// bitmap of the pool when the indices would take more memory than it, so the
+// memory is bounded by both 4 bytes per match and 1 bit per pool element.
+template <typename Ip>
+class BasicIpPoolView_c
+{
+public:
+    class iterator_c
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = Ip;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = Ip*;
+        using reference         = Ip&;
+
+        iterator_c(const BasicIpPoolView_c* view, size_t pos) noexcept : m_view(view), m_pos(pos) {}
+
+        reference operator*() const noexcept  { return m_view->m_base[m_view->index_at(m_pos)]; }
+        pointer   operator->() const noexcept { return &**this; }
+        iterator_c& operator++() noexcept     { m_pos = m_view->next_pos(m_pos); return *this; }
+        bool operator==(const iterator_c& o) const noexcept { return m_pos == o.m_pos; }
+        bool operator!=(const iterator_c& o) const noexcept { return m_pos != o.m_pos; }
+
+    private:
+        const BasicIpPoolView_c*    m_view = nullptr;
+        size_t                 m_pos  = 0;
+    };
+
+    BasicIpPoolView_c() noexcept = default;
+    // Throws std::length_error if the pool can't be indexed by uint32_t.
+    BasicIpPoolView_c(Ip* base, size_t pool_size);
+    explicit BasicIpPoolView_c(std::vector<Ip>& pool) : BasicIpPoolView_c(pool.data(), pool.size()) {}
+
+    // Indices have to be added in the increasing order.
+    void push_back(uint32_t index);
+    void push_back(uint32_t offset, const uint32_t* indices, size_t n);
+    void push_back_range(uint32_t first, uint32_t last);
+    // `other` has to be a view of a part of the pool placed after this one.
+    void append(const BasicIpPoolView_c& other);
+
+    Ip*     base()         const noexcept { return m_base; }
+    size_t  size()         const noexcept { return m_size; }
+    bool    empty()        const noexcept { return 0 == m_size; }
+    bool    is_dense()     const noexcept { return not m_bitmap.empty(); }
+    size_t  memory_usage() const noexcept
+    {
+        return m_idx.capacity() * sizeof(uint32_t) + m_bitmap.capacity() * sizeof(uint64_t);
+    }
+
+    iterator_c begin() const noexcept { return {this, is_dense() ? next_pos(npos()) : 0}; }
+    iterator_c end()   const noexcept { return {this, is_dense() ? m_pool_size : m_idx.size()}; }
+
+    bool operator==(const BasicIpPoolView_c&) const noexcept;
+    bool operator!=(const BasicIpPoolView_c& o) const noexcept { return not (*this == o); }
+
+private:
+    static constexpr size_t WORD_BITS = 64;
+
+    //NOTE: a position is an index of m_idx or a bit of m_bitmap
+    static constexpr size_t npos() noexcept { return SIZE_MAX; }
+    size_t index_at(size_t pos) const noexcept { return is_dense() ? pos : m_idx[pos]; }
+    size_t next_pos(size_t pos) const noexcept;
+
+    void set_bit(size_t index) noexcept { m_bitmap[index / WORD_BITS] |= uint64_t{1} << (index % WORD_BITS); }
+    bool need_bitmap(size_t size) const noexcept
+    {
+        return size * sizeof(uint32_t) > (m_pool_size + WORD_BITS - 1) / WORD_BITS * sizeof(uint64_t);
+    }
+    void to_bitmap();
+
+    Ip*                      m_base      = nullptr;
+    size_t                   m_pool_size = 0;
+    size_t                   m_size      = 0;
+    std::vector<uint32_t>    m_idx;
+    std::vector<uint64_t>    m_bitmap;
+};
+
+using IpPoolView_c       = BasicIpPoolView_c<IpV4_c>;
+using filtered_ip_pool_t = IpPoolView_c;
+
+
+
+namespace utils {
+
+// Addresses of the pool for which `pred(const Ip&)` is true.
+template <typename Ip, typename Pred>
+BasicIpPoolView_c<Ip> filter_if(std::vector<Ip>& ip_pool, Pred pred)
+{
+    BasicIpPoolView_c<Ip> f_pool {ip_pool};
+    for (size_t i = 0; i < ip_pool.size(); ++i)
+    {
+        if (pred(ip_pool[i])) { f_pool.push_back(static_cast<uint32_t>(i)); }
+    }
+    return f_pool;
+}
+
+// The generic filters for any address family.
+template <typename Ip>
+BasicIpPoolView_c<Ip> filter(std::vector<Ip>& ip_pool, const typename Ip::mask_t& mask)
+{
+    return filter_if(ip_pool, [&mask](const Ip& ip) { return ip.match(mask); });
+}
+
+template <typename Ip>
+BasicIpPoolView_c<Ip> filter_any(std::vector<Ip>& ip_pool, uint8_t byte)
+{
+    return filter_if(ip_pool, [byte](const Ip& ip) { return ip.has_byte(byte); });
+}
+
+// IPv4 pools are filtered by the SIMD kernels.
+filtered_ip_pool_t filter(ip_pool_t&, const IpV4_c::mask_t&);
+filtered_ip_pool_t filter_any(ip_pool_t&, uint8_t);
+
+void print(const filtered_ip_pool_t&);
+
+} // namespace utils
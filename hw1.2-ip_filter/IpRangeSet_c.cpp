@@ -0,0 +1,115 @@
+#include "IpRangeSet_c.hpp"
+
+#include <algorithm>
+#include <charconv>   // std::from_chars
+#include <sstream>
+#include <stdexcept>  // std::runtime_error
+
+
+
+std::errc IpRange_s::try_parse(std::string_view str, IpRange_s& range) noexcept
+{
+    IpV4_c first;
+    const size_t sep = str.find_first_of("/-");
+    std::errc ec = first.try_assign(str.substr(0, sep));
+    if (ec != std::errc()) { return ec; }
+
+    if (sep == std::string_view::npos)
+    {
+        range = IpRange_s{first.key(), first.key()};
+        return std::errc();
+    }
+
+    const std::string_view tail = str.substr(sep + 1);
+    if (str[sep] == '-')
+    {
+        IpV4_c last;
+        ec = last.try_assign(tail);
+        if (ec != std::errc())        { return ec; }
+        if (last.key() < first.key()) { return std::errc::invalid_argument; }
+        range = IpRange_s{first.key(), last.key()};
+        return std::errc();
+    }
+
+    unsigned prefix_len = 0;
+    const char* const end = tail.data() + tail.size();
+    const auto [ptr, len_ec] = std::from_chars(tail.data(), end, prefix_len);
+    if (len_ec != std::errc()) { return len_ec; }
+    if (ptr != end)            { return std::errc::invalid_argument; }
+    if (prefix_len > 32)       { return std::errc::result_out_of_range; }
+    range = from_cidr(first, prefix_len);
+    return std::errc();
+}
+
+
+
+IpRange_s IpRange_s::parse(std::string_view str)
+{
+    IpRange_s range;
+    std::errc ec = try_parse(str, range);
+    if (ec != std::errc())
+    {
+        std::stringstream ss{};
+        ss << "IpRange_s::" << __FUNCTION__ << ": invalid range[" << str
+           << "]. Error: " << make_error_code(ec).message();
+        throw std::runtime_error(ss.str());
+    }
+    return range;
+}
+
+
+
+IpRange_s IpRange_s::from_cidr(IpV4_c ip, unsigned prefix_len) noexcept
+{
+    //NOTE: the shift is done in 64 bits because a shift of uint32_t by 32 is UB
+    const uint32_t host_bits = static_cast<uint32_t>(uint64_t{UINT32_MAX} >> prefix_len);
+    return IpRange_s{ip.key() & ~host_bits, ip.key() | host_bits};
+}
+
+
+
+IpRangeSet_c::IpRangeSet_c(std::vector<IpRange_s> ranges)
+    : m_ranges(std::move(ranges))
+{
+    std::sort(m_ranges.begin(), m_ranges.end(),
+              [](const IpRange_s& l, const IpRange_s& r) { return l.lo < r.lo; });
+
+    size_t n = 0;
+    for (const IpRange_s& range : m_ranges)
+    {
+        //NOTE: `hi + 1` is computed in 64 bits to not overflow at 255.255.255.255
+        if (n != 0 && range.lo <= uint64_t{m_ranges[n - 1].hi} + 1)
+        {
+            m_ranges[n - 1].hi = std::max(m_ranges[n - 1].hi, range.hi);
+        }
+        else
+        {
+            m_ranges[n++] = range;
+        }
+    }
+    m_ranges.resize(n);
+}
+
+
+
+IpRangeSet_c IpRangeSet_c::parse(std::string_view str, char delim)
+{
+    std::vector<IpRange_s> ranges;
+    while (not str.empty())
+    {
+        const size_t end = std::min(str.find(delim), str.size());
+        if (end != 0) { ranges.push_back(IpRange_s::parse(str.substr(0, end))); }
+        str.remove_prefix(std::min(end + 1, str.size()));
+    }
+    return IpRangeSet_c{std::move(ranges)};
+}
+
+
+
+bool IpRangeSet_c::contains(uint32_t key) const noexcept
+{
+    //NOTE: the first range with hi >= key is the only candidate
+    auto it = std::lower_bound(m_ranges.cbegin(), m_ranges.cend(), key,
+                               [](const IpRange_s& r, uint32_t k) { return r.hi < k; });
+    return it != m_ranges.cend() && it->lo <= key;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string_view>
+#include <system_error>  // std::errc
+#include <vector>
+
+#include "IpV4_c.hpp"
+
+
+
+// An inclusive range of packed keys [lo, hi].
+struct IpRange_s
+{
+    uint32_t    lo = 0;
+    uint32_t    hi = 0;
+
+    bool contains(uint32_t key) const noexcept { return lo <= key && key <= hi; }
+
+    // Parses "a.b.c.d/len" (host bits are ignored), "a.b.c.d-e.f.g.h" or a
+    // single address.
+    static std::errc try_parse(std::string_view, IpRange_s&) noexcept;
+    // The same, but throws std::runtime_error on an invalid string.
+    static IpRange_s parse(std::string_view);
+    static IpRange_s from_cidr(IpV4_c, unsigned prefix_len) noexcept;
+};
+
+inline bool operator==(const IpRange_s& l, const IpRange_s& r) { return l.lo == r.lo && l.hi == r.hi; }
+inline bool operator!=(const IpRange_s& l, const IpRange_s& r) { return not (l == r); }
+
+
+
+// A set of addresses given by CIDRs and ranges. Stored as sorted, disjoint
+// and not adjacent ranges, so a lookup is a binary search.
+class IpRangeSet_c
+{
+public:
+    IpRangeSet_c() = default;
+    explicit IpRangeSet_c(std::vector<IpRange_s>);
+
+    // Parses a list of ranges (see IpRange_s::parse) separated by `delim`.
+    static IpRangeSet_c parse(std::string_view, char delim = ',');
+
+    const std::vector<IpRange_s>& ranges() const noexcept { return m_ranges; }
+    bool empty() const noexcept { return m_ranges.empty(); }
+
+    bool contains(uint32_t key) const noexcept;
+    bool contains(IpV4_c ip) const noexcept { return contains(ip.key()); }
+
+private:
+    std::vector<IpRange_s>    m_ranges;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+
+
+class IpV4_c;
+
+
+// A contiguous part of a pool of addresses of type Ip.
+template <typename Ip>
+class BasicIpSpan_c
+{
+public:
+    BasicIpSpan_c() noexcept = default;
+    BasicIpSpan_c(Ip* first, Ip* last) noexcept : m_first(first), m_last(last) {}
+
+    Ip*     begin() const noexcept { return m_first; }
+    Ip*     end()   const noexcept { return m_last; }
+    size_t  size()  const noexcept { return m_last - m_first; }
+    bool    empty() const noexcept { return m_first == m_last; }
+    Ip&     operator[](size_t i) const noexcept { return m_first[i]; }
+
+private:
+    Ip*    m_first = nullptr;
+    Ip*    m_last  = nullptr;
+};
+
+using IpSpan_c = BasicIpSpan_c<IpV4_c>;
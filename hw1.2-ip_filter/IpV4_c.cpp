@@ -4,71 +4,60 @@
 #include <vector>
 #include <sstream>
 #include <algorithm>
-#include <charconv>      // std::from_chars
-#include <stdexcept>     // std::runtime_error, std::errc, std::make_error_code
-#include <system_error>  // make_error_code
+#include <stdexcept>     // std::runtime_error
+#include <system_error>  // std::errc, std::make_error_code
 
-#include "utils.hpp"
+#include "IpWriter_c.hpp"
 
 
 
-void IpV4_c::assign(const std::string& str_ipv4)
+void IpV4_c::assign(std::string_view str_ipv4)
 {
-    //TODO: don't use exception
-    std::vector<std::string> bytes = split(str_ipv4, '.');
-    if (bytes.size() != m_bytes.size())
+    std::errc ec = try_assign(str_ipv4);
+    if (ec != std::errc())
     {
         std::stringstream ss{};
-        ss << "IpV4_c::" <<  __FUNCTION__ << ": unexpected number of input digits "
-           << "in IpV4[" << str_ipv4 << "]:"
-           << " exp=" << m_bytes.size() << " act=" << bytes.size();
+        ss << "IpV4_c::" << __FUNCTION__ << ": invalid IpV4[" << str_ipv4
+           << "]. Error: " << make_error_code(ec).message();
         throw std::runtime_error(ss.str());
     }
-    for (size_t i = 0; i < m_bytes.size(); ++i)
-    {
-        const std::string& byte = bytes[i];
-        auto[ptr, ec] = std::from_chars(
-            byte.c_str(), byte.c_str() + byte.size(),
-            m_bytes[i]);
-        if (ec != std::errc())
-        {
-            std::stringstream ss{};
-            ss << "IpV4_c::" << __FUNCTION__ << ": invalid digit [" << byte
-               << "] in IpV4[" << str_ipv4 << "]. Error: " << make_error_code(ec);
-            throw std::runtime_error(ss.str());
-        }
-    }
 }
 
 
 
-std::string IpV4_c::toString() const
+std::errc IpV4_c::try_assign(std::string_view str_ipv4) noexcept
 {
-    //TODO: don't use std::stringstream because of std::locale
-    //      and have to return std::string
-    //      Alternatives:
-    //      - use: snprintf, std::to_chars
-    //      - return: const char*
-    std::stringstream ss;
-    for (auto dig = m_bytes.cbegin(); dig != m_bytes.cend(); ++dig)
+    uint32_t          key = 0;
+    const char*       it  = str_ipv4.data();
+    const char* const end = it + str_ipv4.size();
+    for (size_t i = 0; i < BYTES_NUM; ++i)
     {
-        if (dig != m_bytes.cbegin())
+        if (i != 0)
+        {
+            if (it == end || *it != '.') { return std::errc::invalid_argument; }
+            ++it;
+        }
+        const char* const dig_begin = it;
+        unsigned value = 0;
+        for (; it != end && static_cast<unsigned>(*it - '0') < 10; ++it)
         {
-            ss << '.';
+            value = value * 10 + static_cast<unsigned>(*it - '0');
+            if (value > UINT8_MAX) { return std::errc::result_out_of_range; }
         }
-        ss << static_cast<int>(*dig);
+        if (it == dig_begin) { return std::errc::invalid_argument; }
+        key = (key << 8) | value;
     }
-    return ss.str();
+    if (it != end) { return std::errc::invalid_argument; }
+    m_key = key;
+    return std::errc();
 }
 
 
 
-bool IpV4_c::operator<(const IpV4_c& o) const
+std::string IpV4_c::toString() const
 {
-    if (this == &o) { return false; }
-    return std::lexicographical_compare(
-        m_bytes.cbegin(),   m_bytes.cend(),
-        o.m_bytes.cbegin(), o.m_bytes.cend());
+    char buf[IpWriter_c::MAX_IPV4_LEN];
+    return std::string(buf, IpWriter_c::format(*this, buf));
 }
 
 
@@ -78,7 +67,7 @@ bool IpV4_c::match(const mask_t& mask) const
     for (size_t i = 0; i < mask.size(); ++i)
     {
         if (mask[i] == MATCH_SKIP_BYTE) { continue; }
-        if (mask[i] != m_bytes[i])      { return false; }
+        if (mask[i] != byte(i))         { return false; }
     }
     return true;
 }
@@ -87,7 +76,8 @@ bool IpV4_c::match(const mask_t& mask) const
 
 bool IpV4_c::has_byte(uint8_t byte) const
 {
-    return std::count(m_bytes.cbegin(), m_bytes.cend(), byte) != 0;
+    const std::array<uint8_t, BYTES_NUM> my_bytes = bytes();
+    return std::count(my_bytes.cbegin(), my_bytes.cend(), byte) != 0;
 }
 
 
@@ -103,50 +93,18 @@ std::ostream& operator<<(std::ostream& os, const IpV4_c& ip)
 
 namespace utils {
 
-filtered_ip_pool_t filter(ip_pool_t& ip_pool, const IpV4_c::mask_t& mask)
-{
-    filtered_ip_pool_t f_pool;
-    if (std::all_of(mask.cbegin(), mask.cend(), [](int v){ return v == IpV4_c::MATCH_SKIP_BYTE; }))
-    {
-        f_pool.reserve(ip_pool.size());
-        for (auto& ip : ip_pool) { f_pool.emplace_back(&ip); }
-    }
-    else
-    {
-        //NOTE: evristic reserve
-        f_pool.reserve(ip_pool.size() / 2);
-        for (auto& ip : ip_pool)
-        {
-            if (ip.match(mask)) { f_pool.emplace_back(&ip); }
-        }
-    }
-    return f_pool;
-}
-
-
-
-filtered_ip_pool_t filter_any(ip_pool_t& ip_pool, uint8_t byte)
-{
-    filtered_ip_pool_t f_pool;
-    for (auto& ip : ip_pool)
-    {
-        if (ip.has_byte(byte)) { f_pool.emplace_back(&ip); }
-    }
-    return f_pool;
-}
-
-
-
 void print(const ip_pool_t& ip_pool)
 {
-    for (auto const& ip : ip_pool) { std::cout << ip << '\n'; }
+    IpWriter_c out;
+    print(ip_pool, out);
 }
 
 
 
-void print(const filtered_ip_pool_t& ip_pool)
+void print(const IpSpan_c& ip_span)
 {
-    for (auto const& ip_ptr : ip_pool) { std::cout << *ip_ptr << '\n'; }
+    IpWriter_c out;
+    print(ip_span, out);
 }
 
 } // namespace utils
@@ -2,10 +2,14 @@
 
 #include <array>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <system_error>  // std::errc
 
 #include <cstdint>
 
+#include "IpSpan_c.hpp"
+
 
 
 class IpV4_c
@@ -14,38 +18,64 @@ public:
     static constexpr int MATCH_SKIP_BYTE = -1;
     using mask_t = std::array<int, 4>;
 
-    IpV4_c(const std::string& str) { assign(str); }
-    IpV4_c(const IpV4_c&) = default;
+    static constexpr size_t BYTES_NUM = 4;
+    using key_t = uint32_t;
 
-    void assign(const std::string& str_ipv4);
+    IpV4_c() noexcept = default;
+    IpV4_c(std::string_view str) { assign(str); }
+    IpV4_c(const IpV4_c&) = default;
+    IpV4_c& operator=(const IpV4_c&) = default;
+
+    // Throws std::runtime_error with a description of the problem.
+    void assign(std::string_view str_ipv4);
+    // Parses the dotted quad in one pass without heap allocations.
+    // Returns std::errc() on success; otherwise the object isn't changed and
+    // the result is std::errc::invalid_argument (malformed input) or
+    // std::errc::result_out_of_range (a byte is greater than 255).
+    std::errc try_assign(std::string_view str_ipv4) noexcept;
+
+    // The address packed into an integer: the first byte of the dotted quad
+    // is the most significant one, so the integer order is the address order.
+    static constexpr IpV4_c from_key(uint32_t key) noexcept { IpV4_c ip; ip.m_key = key; return ip; }
+    constexpr uint32_t key() const noexcept { return m_key; }
+
+    constexpr uint8_t byte(size_t i) const noexcept
+    {
+        return static_cast<uint8_t>(m_key >> (8 * (BYTES_NUM - 1 - i)));
+    }
+    std::array<uint8_t, BYTES_NUM> bytes() const noexcept
+    {
+        return { byte(0), byte(1), byte(2), byte(3) };
+    }
 
     std::string toString() const;
 
-    bool operator<(const IpV4_c&) const;
+    bool operator<(const IpV4_c& o) const noexcept  { return m_key < o.m_key; }
+    bool operator==(const IpV4_c& o) const noexcept { return m_key == o.m_key; }
+    bool operator!=(const IpV4_c& o) const noexcept { return m_key != o.m_key; }
     bool match(const mask_t& mask) const;
     bool has_byte(uint8_t) const;
 
 private:
-    std::array<uint8_t, 4> m_bytes;
+    uint32_t    m_key = 0;
 };
 
+static_assert(sizeof(IpV4_c) == sizeof(uint32_t), "IpV4_c has to be a packed key");
+
 
 std::ostream& operator<<(std::ostream&, const IpV4_c&);
 
 
 
-using ip_pool_t          = std::vector<IpV4_c>;
-using filtered_ip_pool_t = std::vector<IpV4_c*>;
+using ip_pool_t = std::vector<IpV4_c>;
 
 
 
 namespace utils {
 
-filtered_ip_pool_t filter(ip_pool_t&, const IpV4_c::mask_t&);
-filtered_ip_pool_t filter_any(ip_pool_t&, uint8_t);
-
+// Print to stdout. See IpWriter_c.hpp to print through a given writer.
 void print(const ip_pool_t&);
-void print(const filtered_ip_pool_t&);
+void print(const IpSpan_c&);
 
 } // namespace utils
 
@@ -0,0 +1,184 @@
+#include "IpV6_c.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>     // std::runtime_error
+
+#include "IpPoolReader.hpp"
+#include "IpWriter_c.hpp"
+
+
+
+namespace {
+
+// The value of a hex digit or 16 if `c` isn't one.
+inline unsigned hex_value(char c) noexcept
+{
+    if (static_cast<unsigned>(c - '0') < 10)         { return c - '0'; }
+    if (static_cast<unsigned>((c | 0x20) - 'a') < 6) { return (c | 0x20) - 'a' + 10; }
+    return 16;
+}
+
+} // namespace
+
+
+
+void IpV6_c::assign(std::string_view str_ipv6)
+{
+    std::errc ec = try_assign(str_ipv6);
+    if (ec != std::errc())
+    {
+        std::stringstream ss{};
+        ss << "IpV6_c::" << __FUNCTION__ << ": invalid IpV6[" << str_ipv6
+           << "]. Error: " << make_error_code(ec).message();
+        throw std::runtime_error(ss.str());
+    }
+}
+
+
+
+std::errc IpV6_c::try_assign(std::string_view str_ipv6) noexcept
+{
+    //NOTE: the groups before and after "::"
+    key_t             head     = 0;
+    key_t             tail     = 0;
+    size_t            head_num = 0;
+    size_t            tail_num = 0;
+    bool              gap      = false;
+    const char*       it       = str_ipv6.data();
+    const char* const end      = it + str_ipv6.size();
+
+    if (end - it >= 2 && it[0] == ':' && it[1] == ':')
+    {
+        gap = true;
+        it += 2;
+    }
+    while (it != end)
+    {
+        const char* const group_begin = it;
+        unsigned value = 0;
+        for (unsigned d; it != end && it - group_begin < 4 && (d = hex_value(*it)) < 16; ++it)
+        {
+            value = value << 4 | d;
+        }
+        if (it == group_begin) { return std::errc::invalid_argument; }
+
+        size_t groups = 1;
+        key_t  bits   = value;
+        if (it != end && *it == '.')
+        {
+            //NOTE: the embedded dotted quad ends the address
+            IpV4_c ipv4;
+            if (ipv4.try_assign({group_begin, static_cast<size_t>(end - group_begin)}) != std::errc())
+            {
+                return std::errc::invalid_argument;
+            }
+            groups = 2;
+            bits   = ipv4.key();
+            it     = end;
+        }
+
+        key_t&  part = gap ? tail : head;
+        size_t& num  = gap ? tail_num : head_num;
+        part = (part << (16 * groups)) | bits;
+        num += groups;
+        if (head_num + tail_num > GROUPS_NUM) { return std::errc::invalid_argument; }
+
+        if (it == end)    { break; }
+        if (*it != ':')   { return std::errc::invalid_argument; }
+        if (++it == end)  { return std::errc::invalid_argument; }
+        if (*it == ':')
+        {
+            if (gap) { return std::errc::invalid_argument; }
+            gap = true;
+            ++it;
+        }
+    }
+
+    const size_t groups = head_num + tail_num;
+    if (gap ? groups == GROUPS_NUM : groups != GROUPS_NUM) { return std::errc::invalid_argument; }
+    //NOTE: the head is shifted over the zero groups and the tail
+    //      (a shift by the whole width is UB, so an empty head is skipped)
+    m_key = (head_num == 0) ? tail : (head << (16 * (GROUPS_NUM - head_num))) | tail;
+    return std::errc();
+}
+
+
+
+std::string IpV6_c::toString() const
+{
+    char buf[IpWriter_c::MAX_IPV6_LEN];
+    return std::string(buf, IpWriter_c::format(*this, buf));
+}
+
+
+
+bool IpV6_c::match(const mask_t& mask) const noexcept
+{
+    for (size_t i = 0; i < mask.size(); ++i)
+    {
+        if (mask[i] == MATCH_SKIP_BYTE) { continue; }
+        if (mask[i] != byte(i))         { return false; }
+    }
+    return true;
+}
+
+
+
+bool IpV6_c::has_byte(uint8_t b) const noexcept
+{
+    for (size_t i = 0; i < BYTES_NUM; ++i)
+    {
+        if (byte(i) == b) { return true; }
+    }
+    return false;
+}
+
+
+
+std::ostream& operator<<(std::ostream& os, const IpV6_c& ip)
+{
+    os << ip.toString();
+    return os;
+}
+
+
+
+namespace utils {
+
+namespace {
+
+void add_to_mixed_pools(mixed_ip_pools_s& pools, std::string_view column)
+{
+    if (column.find(':') != std::string_view::npos) { pools.v6.emplace_back(column); }
+    else                                             { pools.v4.emplace_back(column); }
+}
+
+} // namespace
+
+
+
+mixed_ip_pools_s make_mixed_ip_pools(std::string_view text)
+{
+    mixed_ip_pools_s pools;
+    for_each_first_column_eof(text, [&pools](std::string_view column)
+    {
+        add_to_mixed_pools(pools, column);
+    });
+    return pools;
+}
+
+
+
+mixed_ip_pools_s make_mixed_ip_pools(FILE* stream, size_t* bytes_read)
+{
+    mixed_ip_pools_s pools;
+    const size_t read = read_first_columns(stream, [&pools](std::string_view column)
+    {
+        add_to_mixed_pools(pools, column);
+    });
+    if (bytes_read) { *bytes_read = read; }
+    return pools;
+}
+
+} // namespace utils
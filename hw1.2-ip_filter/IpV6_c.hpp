@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <cstdio>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <system_error>  // std::errc
+
+#include <cstdint>
+
+#include "IpV4_c.hpp"
+#include "IpPoolView_c.hpp"
+
+
+
+class IpV6_c
+{
+public:
+    static constexpr int MATCH_SKIP_BYTE = IpV4_c::MATCH_SKIP_BYTE;
+    using mask_t = std::array<int, 16>;
+
+    static constexpr size_t BYTES_NUM  = 16;
+    static constexpr size_t GROUPS_NUM = 8;
+    __extension__ using key_t = unsigned __int128;
+
+    IpV6_c() noexcept = default;
+    IpV6_c(std::string_view str) { assign(str); }
+
+    // Throws std::runtime_error with a description of the problem.
+    void assign(std::string_view str_ipv6);
+    // Parses 8 groups of 1-4 hex digits separated by ':' in one pass. One
+    // "::" may replace a run of zero groups and the last two groups may be
+    // written as a dotted quad ("::ffff:1.2.3.4"). Returns std::errc() on
+    // success; otherwise the object isn't changed and the result is
+    // std::errc::invalid_argument.
+    std::errc try_assign(std::string_view str_ipv6) noexcept;
+
+    // The address packed into an integer: the first group is the most
+    // significant one, so the integer order is the address order.
+    static constexpr IpV6_c from_key(key_t key) noexcept { IpV6_c ip; ip.m_key = key; return ip; }
+    constexpr key_t key() const noexcept { return m_key; }
+
+    constexpr uint8_t byte(size_t i) const noexcept
+    {
+        return static_cast<uint8_t>(m_key >> (8 * (BYTES_NUM - 1 - i)));
+    }
+    constexpr uint16_t group(size_t i) const noexcept
+    {
+        return static_cast<uint16_t>(m_key >> (16 * (GROUPS_NUM - 1 - i)));
+    }
+
+    // The canonical text form (RFC 5952): lowercase, no leading zeros and
+    // the longest run of two or more zero groups replaced by "::". An
+    // IPv4-mapped address ends with the dotted quad ("::ffff:1.2.3.4").
+    std::string toString() const;
+
+    bool operator<(const IpV6_c& o) const noexcept  { return m_key < o.m_key; }
+    bool operator==(const IpV6_c& o) const noexcept { return m_key == o.m_key; }
+    bool operator!=(const IpV6_c& o) const noexcept { return m_key != o.m_key; }
+    bool match(const mask_t& mask) const noexcept;
+    bool has_byte(uint8_t) const noexcept;
+
+private:
+    key_t    m_key = 0;
+};
+
+static_assert(sizeof(IpV6_c) == 16, "IpV6_c has to be a packed key");
+
+
+std::ostream& operator<<(std::ostream&, const IpV6_c&);
+
+
+
+using ip6_pool_t          = std::vector<IpV6_c>;
+using IpV6Span_c          = BasicIpSpan_c<IpV6_c>;
+//NOTE: IPv6 pools are filtered by the generic utils::filter and filter_any
+using IpV6PoolView_c      = BasicIpPoolView_c<IpV6_c>;
+using filtered_ip6_pool_t = IpV6PoolView_c;
+
+
+// Both address families of a mixed input.
+struct mixed_ip_pools_s
+{
+    ip_pool_t     v4;
+    ip6_pool_t    v6;
+};
+
+
+
+namespace utils {
+
+// Parses the first columns of a mixed input in a single pass: an address
+// with ':' goes to the IPv6 pool, any other one to the IPv4 pool.
+mixed_ip_pools_s make_mixed_ip_pools(std::string_view text);
+// `bytes_read` is the size of the read input if it isn't null.
+mixed_ip_pools_s make_mixed_ip_pools(FILE* stream, size_t* bytes_read = nullptr);
+
+} // namespace utils
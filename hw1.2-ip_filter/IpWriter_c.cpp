@@ -0,0 +1,161 @@
+#include "IpWriter_c.hpp"
+
+#include <algorithm>  // std::min, std::max
+#include <array>
+#include <charconv>      // std::to_chars
+#include <cstring>       // std::memcpy
+#include <system_error>  // std::system_error
+
+#include <cerrno>
+
+
+
+namespace {
+
+struct digits_s
+{
+    char        chars[3] = {};
+    uint8_t     len      = 0;
+};
+
+constexpr std::array<digits_s, 256> make_digits_table()
+{
+    std::array<digits_s, 256> table {};
+    for (unsigned v = 0; v < table.size(); ++v)
+    {
+        digits_s& d = table[v];
+        if (v >= 100) { d.chars[d.len++] = static_cast<char>('0' + v / 100); }
+        if (v >= 10)  { d.chars[d.len++] = static_cast<char>('0' + v / 10 % 10); }
+        d.chars[d.len++] = static_cast<char>('0' + v % 10);
+    }
+    return table;
+}
+
+constexpr std::array<digits_s, 256> DIGITS = make_digits_table();
+
+} // namespace
+
+
+
+IpWriter_c::IpWriter_c(int fd, size_t buffer_size)
+    : m_fd{fd}
+    , m_capacity{std::max(buffer_size, MAX_IPV6_LEN + 1)}
+    , m_buffer{new char[m_capacity]}
+{
+}
+
+
+
+IpWriter_c::~IpWriter_c()
+{
+    try { flush(); }
+    catch (const std::system_error&) {}
+}
+
+
+
+void IpWriter_c::write(std::string_view str)
+{
+    while (not str.empty())
+    {
+        if (m_size == m_capacity) { flush(); }
+        const size_t n = std::min(str.size(), m_capacity - m_size);
+        std::memcpy(m_buffer.get() + m_size, str.data(), n);
+        m_size += n;
+        str.remove_prefix(n);
+    }
+}
+
+
+
+void IpWriter_c::write_number(uint64_t number)
+{
+    reserve(MAX_NUMBER_LEN);
+    char* const first = m_buffer.get() + m_size;
+    m_size += static_cast<size_t>(std::to_chars(first, first + MAX_NUMBER_LEN, number).ptr - first);
+}
+
+
+
+void IpWriter_c::flush()
+{
+    const char* data = m_buffer.get();
+    size_t      left = m_size;
+    m_size = 0;
+    while (left != 0)
+    {
+        const ssize_t n = ::write(m_fd, data, left);
+        if (n < 0)
+        {
+            if (errno == EINTR) { continue; }
+            throw std::system_error(errno, std::generic_category(), "Can't write the output");
+        }
+        data      += n;
+        left      -= static_cast<size_t>(n);
+        m_flushed += static_cast<size_t>(n);
+    }
+}
+
+
+
+size_t IpWriter_c::format(const IpV4_c& ip, char* out) noexcept
+{
+    char* it = out;
+    for (size_t i = 0; i < IpV4_c::BYTES_NUM; ++i)
+    {
+        if (i != 0) { *it++ = '.'; }
+        //NOTE: all 3 chars are copied to avoid a branch, the tail is overwritten
+        const digits_s& d = DIGITS[ip.byte(i)];
+        std::memcpy(it, d.chars, sizeof(d.chars));
+        it += d.len;
+    }
+    return static_cast<size_t>(it - out);
+}
+
+
+
+size_t IpWriter_c::format(const IpV6_c& ip, char* out) noexcept
+{
+    static constexpr char HEX[] = "0123456789abcdef";
+    static constexpr std::string_view MAPPED_PREFIX = "::ffff:";
+
+    //NOTE: IPv4-mapped addresses (::ffff:0:0/96) are written in the mixed
+    //      notation as RFC 5952 section 5 recommends
+    if (static_cast<uint64_t>(ip.key() >> 32) == 0xFFFFu)
+    {
+        std::memcpy(out, MAPPED_PREFIX.data(), MAPPED_PREFIX.size());
+        return MAPPED_PREFIX.size()
+             + format(IpV4_c::from_key(static_cast<uint32_t>(ip.key())), out + MAPPED_PREFIX.size());
+    }
+
+    //NOTE: the first longest run of two or more zero groups becomes "::"
+    size_t gap_begin = IpV6_c::GROUPS_NUM;
+    size_t gap_len   = 1;
+    for (size_t i = 0; i < IpV6_c::GROUPS_NUM; )
+    {
+        size_t len = 0;
+        while (i + len < IpV6_c::GROUPS_NUM && ip.group(i + len) == 0) { ++len; }
+        if (len > gap_len) { gap_begin = i; gap_len = len; }
+        i += len + 1;
+    }
+
+    char* it = out;
+    for (size_t i = 0; i < IpV6_c::GROUPS_NUM; ++i)
+    {
+        if (i == gap_begin)
+        {
+            *it++ = ':';
+            *it++ = ':';
+            i += gap_len - 1;
+            continue;
+        }
+        if (i != 0 && i != gap_begin + gap_len) { *it++ = ':'; }
+        const uint16_t group = ip.group(i);
+        for (int shift = (group > 0xFFF) ? 12 : (group > 0xFF) ? 8 : (group > 0xF) ? 4 : 0;
+             shift >= 0; shift -= 4)
+        {
+            *it++ = HEX[(group >> shift) & 0xF];
+        }
+    }
+    return static_cast<size_t>(it - out);
+}
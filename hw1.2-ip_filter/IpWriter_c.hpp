@@ -0,0 +1,90 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+
+#include <unistd.h>  // STDOUT_FILENO
+
+#include "IpV4_c.hpp"
+#include "IpV6_c.hpp"
+
+
+
+// Buffered writer of addresses to a file descriptor. Formats dotted quads
+// by a precomputed table into a big buffer and flushes it by write(2).
+class IpWriter_c
+{
+public:
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 1 << 20;
+    // The longest dotted quad: "255.255.255.255"
+    static constexpr size_t MAX_IPV4_LEN = 15;
+    // The longest canonical IPv6: "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff"
+    static constexpr size_t MAX_IPV6_LEN = 39;
+    // The longest decimal uint64_t: "18446744073709551615"
+    static constexpr size_t MAX_NUMBER_LEN = 20;
+
+    explicit IpWriter_c(int fd = STDOUT_FILENO, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+    // Flushes the rest ignoring errors: call flush() to get them.
+    ~IpWriter_c();
+    IpWriter_c(const IpWriter_c&)            = delete;
+    IpWriter_c& operator=(const IpWriter_c&) = delete;
+
+    // Writes the address followed by `end`.
+    void write(const IpV4_c& ip, char end = '\n')
+    {
+        reserve(MAX_IPV4_LEN + 1);
+        m_size += format(ip, m_buffer.get() + m_size);
+        m_buffer[m_size++] = end;
+    }
+    void write(const IpV6_c& ip, char end = '\n')
+    {
+        reserve(MAX_IPV6_LEN + 1);
+        m_size += format(ip, m_buffer.get() + m_size);
+        m_buffer[m_size++] = end;
+    }
+    void write(std::string_view);
+    void write(char c)
+    {
+        reserve(1);
+        m_buffer[m_size++] = c;
+    }
+    // Writes the decimal number.
+    void write_number(uint64_t);
+    // Throws std::system_error if write(2) fails.
+    void flush();
+    // The bytes written so far including the buffered ones.
+    size_t bytes_written() const noexcept { return m_flushed + m_size; }
+
+    // Writes the dotted quad to `out` (MAX_IPV4_LEN bytes at least) and
+    // returns its length.
+    static size_t format(const IpV4_c&, char* out) noexcept;
+    // The same for the canonical form of IpV6_c (MAX_IPV6_LEN bytes).
+    // IPv4-mapped addresses end with the dotted quad ("::ffff:1.2.3.4").
+    static size_t format(const IpV6_c&, char* out) noexcept;
+
+private:
+    void reserve(size_t n)
+    {
+        if (m_capacity - m_size < n) { flush(); }
+    }
+
+    int                        m_fd;
+    size_t                     m_capacity;
+    size_t                     m_size = 0;
+    size_t                     m_flushed = 0;
+    std::unique_ptr<char[]>    m_buffer;
+};
+
+
+
+namespace utils {
+
+// Writes the addresses of a pool, a span or a view of either family through
+// the writer (which is not flushed).
+template <typename Ips>
+void print(const Ips& ips, IpWriter_c& out)
+{
+    for (auto const& ip : ips) { out.write(ip); }
+}
+
+} // namespace utils
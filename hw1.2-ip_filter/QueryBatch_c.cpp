@@ -0,0 +1,76 @@
+#include "QueryBatch_c.hpp"
+
+#include <algorithm>  // std::min
+
+
+
+size_t QueryBatch_c::add_mask(const IpV4_c::mask_t& mask)
+{
+    m_mask_ids.push_back(m_kinds.size());
+    m_mask_keys.push_back(kernels::make_mask_key(mask));
+    m_kinds.push_back(kind_e::MASK);
+    return m_kinds.size() - 1;
+}
+
+
+
+size_t QueryBatch_c::add_any_byte(uint8_t byte)
+{
+    const size_t q = m_any_byte_ids.size();
+    if (q % QUERIES_PER_TABLE == 0) { m_any_byte_tables.emplace_back(); }
+    m_any_byte_tables.back()[byte] |= uint64_t{1} << (q % QUERIES_PER_TABLE);
+    m_any_byte_ids.push_back(m_kinds.size());
+    m_kinds.push_back(kind_e::ANY_BYTE);
+    return m_kinds.size() - 1;
+}
+
+
+
+QueryBatch_c::results_t QueryBatch_c::run(ip_pool_t& ip_pool) const
+{
+    results_t results;
+    run(ip_pool, 0, ip_pool.size(), results);
+    return results;
+}
+
+
+
+void QueryBatch_c::run(ip_pool_t& ip_pool, size_t begin, size_t end, results_t& results) const
+{
+    //NOTE: the block is small enough to stay in L1 while all queries scan it
+    constexpr size_t BLOCK_SIZE = 1024;
+    uint32_t idx[BLOCK_SIZE];
+
+    results.resize(m_kinds.size(), filtered_ip_pool_t{ip_pool});
+    for (size_t block = begin; block < end; block += BLOCK_SIZE)
+    {
+        const uint32_t* keys       = kernels::keys_of(ip_pool.data() + block);
+        const size_t    block_size = std::min(BLOCK_SIZE, end - block);
+
+        for (size_t m = 0; m < m_mask_keys.size(); ++m)
+        {
+            const size_t        n      = kernels::match_mask(keys, block_size, m_mask_keys[m], idx);
+            filtered_ip_pool_t& result = results[m_mask_ids[m]];
+            result.push_back(static_cast<uint32_t>(ip_pool.data() + block - result.base()), idx, n);
+        }
+
+        for (size_t t = 0; t < m_any_byte_tables.size(); ++t)
+        {
+            const any_byte_table_t& table = m_any_byte_tables[t];
+            for (size_t i = 0; i < block_size; ++i)
+            {
+                const uint32_t key = keys[i];
+                //NOTE: the bitmap of the queries matched by the address
+                uint64_t matched = table[key >> 24] | table[(key >> 16) & 0xFF]
+                                 | table[(key >> 8) & 0xFF] | table[key & 0xFF];
+                while (matched)
+                {
+                    const size_t        q      = t * QUERIES_PER_TABLE + __builtin_ctzll(matched);
+                    filtered_ip_pool_t& result = results[m_any_byte_ids[q]];
+                    result.push_back(static_cast<uint32_t>(ip_pool.data() + block + i - result.base()));
+                    matched &= matched - 1;
+                }
+            }
+        }
+    }
+}
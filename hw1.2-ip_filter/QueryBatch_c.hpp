@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "IpV4_c.hpp"
+#include "IpPoolView_c.hpp"
+#include "FilterKernels.hpp"
+
+
+
+// A set of filter queries which are evaluated by a single pass over a pool.
+// results[i] of `run` is equal to the result of utils::filter/filter_any for
+// the i-th registered query.
+class QueryBatch_c
+{
+public:
+    using results_t = std::vector<filtered_ip_pool_t>;
+
+    // Both return the index of the query in the results.
+    size_t add_mask(const IpV4_c::mask_t&);
+    size_t add_any_byte(uint8_t);
+
+    size_t size() const noexcept { return m_kinds.size(); }
+
+    results_t run(ip_pool_t&) const;
+    // Appends the results for the pool elements [begin, end) to `results`.
+    // The results which are already there may be views of a part of the
+    // pool starting at `begin` or earlier.
+    void run(ip_pool_t&, size_t begin, size_t end, results_t& results) const;
+
+private:
+    enum class kind_e { MASK, ANY_BYTE };
+    using any_byte_table_t = std::array<uint64_t, 256>;
+    static constexpr size_t QUERIES_PER_TABLE = 64;
+
+    std::vector<kind_e>                       m_kinds;
+    // query's index in the results by its index in the related group
+    std::vector<size_t>                       m_mask_ids;
+    std::vector<kernels::mask_key_s>          m_mask_keys;
+    std::vector<size_t>                       m_any_byte_ids;
+    // bit `q` of table[byte] is set if the query `q` looks for `byte`
+    std::vector<any_byte_table_t>             m_any_byte_tables;
+};
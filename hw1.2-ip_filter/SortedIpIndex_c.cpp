@@ -0,0 +1,122 @@
+#include "SortedIpIndex_c.hpp"
+
+#include <algorithm>
+#include <stdexcept>  // std::length_error
+
+#include "FilterKernels.hpp"
+
+
+
+SortedIpIndex_c::SortedIpIndex_c(ip_pool_t& ip_pool, utils::sort_order_e order)
+    : m_first(ip_pool.data())
+    , m_order(order)
+    , m_offsets(BUCKETS + 1, 0)
+{
+    if (ip_pool.size() > UINT32_MAX)
+    {
+        throw std::length_error("SortedIpIndex_c: the pool is too big");
+    }
+    for (const IpV4_c& ip : ip_pool) { ++m_offsets[rank(ip.key() >> BUCKET_BITS) + 1]; }
+    for (size_t r = 1; r <= BUCKETS; ++r) { m_offsets[r] += m_offsets[r - 1]; }
+}
+
+
+
+bool SortedIpIndex_c::is_prefix(const IpV4_c::mask_t& mask) noexcept
+{
+    auto first_skip = std::find(mask.cbegin(), mask.cend(), IpV4_c::MATCH_SKIP_BYTE);
+    return std::all_of(first_skip, mask.cend(), [](int v) { return v == IpV4_c::MATCH_SKIP_BYTE; });
+}
+
+
+
+IpV4_c* SortedIpIndex_c::bound(uint32_t key, bool inclusive) const noexcept
+{
+    const uint32_t bucket = key >> BUCKET_BITS;
+    const bool     asc    = (m_order == utils::sort_order_e::ASC);
+    return std::partition_point(bucket_begin(bucket), bucket_end(bucket),
+        [key, inclusive, asc](const IpV4_c& ip)
+        {
+            if (ip.key() == key) { return inclusive; }
+            return asc ? ip.key() < key : ip.key() > key;
+        });
+}
+
+
+
+IpSpan_c SortedIpIndex_c::key_range(uint32_t lo, uint32_t hi) const noexcept
+{
+    if (lo > hi) { return {}; }
+    if (m_order == utils::sort_order_e::ASC) { return {bound(lo, false), bound(hi, true)}; }
+    else                                     { return {bound(hi, false), bound(lo, true)}; }
+}
+
+
+
+IpSpan_c SortedIpIndex_c::prefix_range(const IpV4_c::mask_t& mask) const noexcept
+{
+    const kernels::mask_key_s mk = kernels::make_mask_key(mask);
+    if (mk.value & ~mk.bitmask) { return {}; }
+    return key_range(mk.value, mk.value | ~mk.bitmask);
+}
+
+
+
+filtered_ip_pool_t SortedIpIndex_c::filter(const IpV4_c::mask_t& mask) const
+{
+    filtered_ip_pool_t f_pool {m_first, m_offsets.back()};
+    const kernels::mask_key_s mk = kernels::make_mask_key(mask);
+    if (mk.value & ~mk.bitmask) { return f_pool; }
+
+    if (is_prefix(mask))
+    {
+        IpSpan_c span = prefix_range(mask);
+        f_pool.push_back_range(static_cast<uint32_t>(span.begin() - m_first),
+                               static_cast<uint32_t>(span.end() - m_first));
+        return f_pool;
+    }
+
+    IpV4_c::mask_t prefix = mask;
+    auto first_skip = std::find(prefix.begin(), prefix.end(), IpV4_c::MATCH_SKIP_BYTE);
+    std::fill(first_skip, prefix.end(), IpV4_c::MATCH_SKIP_BYTE);
+    if (first_skip != prefix.begin())
+    {
+        IpSpan_c span = prefix_range(prefix);
+        kernels::filter(span.begin(), span.size(), mk, f_pool);
+    }
+    else if (mask[1] != IpV4_c::MATCH_SKIP_BYTE)
+    {
+        //NOTE: the second byte is fixed, so only 256 buckets are candidates
+        for (size_t i = 0; i < 256; ++i)
+        {
+            const uint32_t b0     = (m_order == utils::sort_order_e::ASC) ? i : 255 - i;
+            const uint32_t bucket = b0 << 8 | static_cast<uint32_t>(mask[1]);
+            kernels::filter(bucket_begin(bucket), bucket_end(bucket) - bucket_begin(bucket), mk, f_pool);
+        }
+    }
+    else
+    {
+        kernels::filter(m_first, m_offsets.back(), mk, f_pool);
+    }
+    return f_pool;
+}
+
+
+
+filtered_ip_pool_t SortedIpIndex_c::filter(const IpRangeSet_c& set) const
+{
+    filtered_ip_pool_t f_pool {m_first, m_offsets.back()};
+    auto add = [this, &f_pool](const IpRange_s& r)
+    {
+        IpSpan_c span = range(r);
+        if (span.empty()) { return; }
+        f_pool.push_back_range(static_cast<uint32_t>(span.begin() - m_first),
+                               static_cast<uint32_t>(span.end() - m_first));
+    };
+    //NOTE: the ranges are disjoint, so their spans follow the pool order
+    //      if the ranges are visited in the same order
+    const std::vector<IpRange_s>& ranges = set.ranges();
+    if (m_order == utils::sort_order_e::ASC) { std::for_each(ranges.cbegin(), ranges.cend(), add); }
+    else                                     { std::for_each(ranges.crbegin(), ranges.crend(), add); }
+    return f_pool;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+#include "IpV4_c.hpp"
+#include "IpPoolView_c.hpp"
+#include "IpPoolSort.hpp"
+#include "IpRangeSet_c.hpp"
+
+
+
+// An index over a sorted pool: offsets of every first-two-bytes bucket.
+// The pool must outlive the index and must not be changed while it's used.
+class SortedIpIndex_c
+{
+public:
+    SortedIpIndex_c(ip_pool_t&, utils::sort_order_e);
+
+    // A mask is a prefix one if it doesn't have fixed bytes after skipped ones.
+    static bool is_prefix(const IpV4_c::mask_t&) noexcept;
+
+    // Addresses with keys in [lo, hi]. O(log(bucket size)).
+    IpSpan_c key_range(uint32_t lo, uint32_t hi) const noexcept;
+    IpSpan_c range(const IpRange_s& r) const noexcept { return key_range(r.lo, r.hi); }
+    // Addresses matched by a prefix mask.
+    IpSpan_c prefix_range(const IpV4_c::mask_t&) const noexcept;
+    // Addresses matched by any mask in the order of the pool. Leading fixed
+    // bytes narrow the scan to the candidate buckets.
+    filtered_ip_pool_t filter(const IpV4_c::mask_t&) const;
+    // Addresses in any range of the set in the order of the pool.
+    // O(ranges * log(bucket size)) plus the size of the result.
+    filtered_ip_pool_t filter(const IpRangeSet_c&) const;
+
+private:
+    static constexpr size_t BUCKET_BITS = 16;
+    static constexpr size_t BUCKETS     = size_t{1} << BUCKET_BITS;
+
+    // Rank of the bucket in the pool order.
+    size_t rank(uint32_t bucket) const noexcept
+    {
+        return (m_order == utils::sort_order_e::ASC) ? bucket : BUCKETS - 1 - bucket;
+    }
+    IpV4_c* bucket_begin(uint32_t bucket) const noexcept { return m_first + m_offsets[rank(bucket)]; }
+    IpV4_c* bucket_end(uint32_t bucket)   const noexcept { return m_first + m_offsets[rank(bucket) + 1]; }
+
+    // The first address which isn't placed in front of `key` in the pool
+    // order; with `inclusive` the addresses equal to `key` are skipped too.
+    IpV4_c* bound(uint32_t key, bool inclusive) const noexcept;
+
+    IpV4_c*                  m_first = nullptr;
+    utils::sort_order_e      m_order;
+    // m_offsets[r] is the index of the first address of the bucket of rank r
+    std::vector<uint32_t>    m_offsets;
+};
@@ -0,0 +1,99 @@
+#include "StageStats_c.hpp"
+
+#include <new>             // std::bad_alloc
+
+#include <sys/resource.h>  // getrusage
+
+#include "IpWriter_c.hpp"
+
+
+
+namespace {
+
+double cpu_elapsed_ms(const timespec& start) noexcept
+{
+    timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return (now.tv_sec - start.tv_sec) * 1e3 + (now.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+
+size_t peak_rss_kb() noexcept
+{
+    rusage usage;
+    //NOTE: Linux reports ru_maxrss in kilobytes
+    return (getrusage(RUSAGE_SELF, &usage) == 0) ? static_cast<size_t>(usage.ru_maxrss) : 0;
+}
+
+} // namespace
+
+
+
+StageStats_c& StageStats_c::instance() noexcept
+{
+    static StageStats_c stats;
+    return stats;
+}
+
+
+
+void StageStats_c::report(FILE* out, format_e format) const
+{
+    if (format == format_e::JSON)
+    {
+        fputs("{\"stages\": [", out);
+        for (size_t i = 0; i < m_stages.size(); ++i)
+        {
+            const stage_stats_s& s = m_stages[i];
+            fprintf(out, "%s\n  {\"name\": \"%s\", \"wall_ms\": %.3f, \"cpu_ms\": %.3f, \"items\": %zu, "
+                         "\"bytes_in\": %zu, \"bytes_out\": %zu, \"peak_rss_kb\": %zu}",
+                    (i == 0) ? "" : ",", s.name, s.wall_ms, s.cpu_ms, s.items,
+                    s.bytes_in, s.bytes_out, s.peak_rss_kb);
+        }
+        fputs("\n]}\n", out);
+        return;
+    }
+
+    fprintf(out, "%-20s %10s %10s %12s %12s %12s %12s\n",
+            "stage", "wall ms", "cpu ms", "items", "bytes in", "bytes out", "peak rss KiB");
+    for (const stage_stats_s& s : m_stages)
+    {
+        fprintf(out, "%-20s %10.3f %10.3f %12zu %12zu %12zu %12zu\n",
+                s.name, s.wall_ms, s.cpu_ms, s.items, s.bytes_in, s.bytes_out, s.peak_rss_kb);
+    }
+}
+
+
+
+StageScope_c::StageScope_c(const char* name, StageStats_c& stats) noexcept
+    : m_stats{stats}
+    , m_active{stats.enabled()}
+{
+    if (not m_active) { return; }
+    m_stage.name = name;
+    m_wall_start = std::chrono::steady_clock::now();
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &m_cpu_start);
+}
+
+
+
+StageScope_c::~StageScope_c()
+{
+    if (not m_active) { return; }
+    m_stage.wall_ms     = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - m_wall_start).count();
+    m_stage.cpu_ms      = cpu_elapsed_ms(m_cpu_start);
+    m_stage.peak_rss_kb = peak_rss_kb();
+    if (m_out) { m_stage.bytes_out = m_out->bytes_written() - m_out_start; }
+    //NOTE: a destructor must not throw, a stage is lost if there's no memory
+    try { m_stats.add(m_stage); }
+    catch (const std::bad_alloc&) {}
+}
+
+
+
+void StageScope_c::output(const IpWriter_c& out) noexcept
+{
+    m_out       = &out;
+    m_out_start = out.bytes_written();
+}
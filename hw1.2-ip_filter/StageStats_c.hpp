@@ -0,0 +1,104 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+
+
+
+class IpWriter_c;
+
+
+
+struct stage_stats_s
+{
+    // A string literal: the stages are named at the call sites.
+    const char*    name        = "";
+    double         wall_ms     = 0;
+    // The CPU time of the whole process, i.e. of all threads.
+    double         cpu_ms      = 0;
+    size_t         items       = 0;
+    size_t         bytes_in    = 0;
+    size_t         bytes_out   = 0;
+    // The peak RSS of the process at the end of the stage.
+    size_t         peak_rss_kb = 0;
+};
+
+
+
+// Per-stage timings of the pipeline reported by `--stats`. It's collected
+// by STATS_* macros from the main thread only.
+class StageStats_c
+{
+public:
+    enum class format_e { TEXT, JSON };
+
+    static StageStats_c& instance() noexcept;
+
+    void enable(format_e format) noexcept { m_enabled = true; m_format = format; }
+    bool enabled() const noexcept         { return m_enabled; }
+    format_e format() const noexcept      { return m_format; }
+
+    void add(const stage_stats_s& stage)  { m_stages.push_back(stage); }
+    const std::vector<stage_stats_s>& stages() const noexcept { return m_stages; }
+
+    void report(FILE* out) const { report(out, m_format); }
+    void report(FILE* out, format_e format) const;
+
+private:
+    std::vector<stage_stats_s>    m_stages;
+    bool                          m_enabled = false;
+    format_e                      m_format  = format_e::TEXT;
+};
+
+
+
+// Measures a stage from the construction to the destruction and adds it
+// to the stats. Does nothing (not even reads the clocks) if they aren't
+// enabled.
+class StageScope_c
+{
+public:
+    explicit StageScope_c(const char* name, StageStats_c& stats = StageStats_c::instance()) noexcept;
+    ~StageScope_c();
+    StageScope_c(const StageScope_c&)            = delete;
+    StageScope_c& operator=(const StageScope_c&) = delete;
+
+    // False if the stats aren't enabled: then the scope does nothing.
+    bool active() const noexcept     { return m_active; }
+    void items(size_t n) noexcept    { m_stage.items += n; }
+    void bytes_in(size_t n) noexcept { m_stage.bytes_in += n; }
+    // The bytes written by `out` during the stage are its output.
+    void output(const IpWriter_c& out) noexcept;
+
+private:
+    StageStats_c&                            m_stats;
+    const bool                               m_active;
+    stage_stats_s                            m_stage;
+    std::chrono::steady_clock::time_point    m_wall_start;
+    timespec                                 m_cpu_start {};
+    const IpWriter_c*                        m_out       = nullptr;
+    size_t                                   m_out_start = 0;
+};
+
+
+
+//NOTE: the stages are measured only if ENABLE_STATS is defined (the CMake
+//      option IP_FILTER_STATS), otherwise the macros and their arguments
+//      are compiled out completely: sizeof doesn't evaluate the arguments
+//      but keeps the variables used only by the stats used. If the stats
+//      are built but `--stats` isn't given, a scope costs a flag check and
+//      the arguments of the other macros aren't evaluated, so they may be
+//      computed after a loop instead of counted in it.
+#ifdef ENABLE_STATS
+#    define STATS_SCOPE(name)    StageScope_c stats_scope_ {name}
+#    define STATS_ITEMS(n)       (stats_scope_.active() ? stats_scope_.items(n) : void())
+#    define STATS_BYTES_IN(n)    (stats_scope_.active() ? stats_scope_.bytes_in(n) : void())
+#    define STATS_OUTPUT(out)    (stats_scope_.active() ? stats_scope_.output(out) : void())
+#else
+#    define STATS_SCOPE(name)    static_cast<void>(sizeof(name))
+#    define STATS_ITEMS(n)       static_cast<void>(sizeof(n))
+#    define STATS_BYTES_IN(n)    static_cast<void>(sizeof(n))
+#    define STATS_OUTPUT(out)    static_cast<void>(sizeof(out))
+#endif
@@ -0,0 +1,26 @@
+#include "StreamFilter_c.hpp"
+
+
+
+StreamFilter_c::StreamFilter_c(const QueryBatch_c& queries, on_matches_f on_matches, void* ctx)
+    : m_queries{queries}
+    , m_on_matches{on_matches}
+    , m_ctx{ctx}
+{
+    m_block.reserve(BLOCK_SIZE);
+}
+
+
+
+void StreamFilter_c::flush()
+{
+    if (m_block.empty()) { return; }
+    m_results.clear();
+    m_queries.run(m_block, 0, m_block.size(), m_results);
+    for (size_t q = 0; q < m_results.size(); ++q)
+    {
+        if (not m_results[q].empty()) { m_on_matches(q, m_results[q], m_ctx); }
+    }
+    m_flushed += m_block.size();
+    m_block.clear();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "IpV4_c.hpp"
+#include "QueryBatch_c.hpp"
+
+
+
+// Evaluates a query batch over a stream of addresses without keeping the
+// stream: addresses are buffered by blocks and only the matches of every
+// block are passed to `on_matches(size_t query, const filtered_ip_pool_t&)`.
+// The views refer to the internal block, so they are valid during the call.
+class StreamFilter_c
+{
+public:
+    static constexpr size_t BLOCK_SIZE = 1024;
+
+    using on_matches_f = void (*)(size_t query, const filtered_ip_pool_t&, void* ctx);
+
+    // The batch and `ctx` must outlive the filter.
+    StreamFilter_c(const QueryBatch_c&, on_matches_f, void* ctx);
+
+    template <typename F>
+    StreamFilter_c(const QueryBatch_c& queries, F& on_matches)
+        : StreamFilter_c(
+            queries,
+            [](size_t query, const filtered_ip_pool_t& matches, void* ctx)
+            {
+                (*static_cast<F*>(ctx))(query, matches);
+            },
+            &on_matches)
+    {}
+
+    // Returns true if the block was full and its matches have been passed on.
+    bool add(IpV4_c ip)
+    {
+        m_block.push_back(ip);
+        if (m_block.size() != BLOCK_SIZE) { return false; }
+        flush();
+        return true;
+    }
+    // Passes on the matches of the buffered addresses. Has to be called at
+    // the end of the stream.
+    void flush();
+
+    // The number of added addresses.
+    size_t size() const noexcept { return m_flushed + m_block.size(); }
+
+private:
+    const QueryBatch_c&        m_queries;
+    on_matches_f               m_on_matches;
+    void*                      m_ctx;
+    ip_pool_t                  m_block;
+    QueryBatch_c::results_t    m_results;
+    size_t                     m_flushed = 0;
+};
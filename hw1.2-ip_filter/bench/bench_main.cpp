@@ -0,0 +1,369 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+#include <random>
+#include <charconv>
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "IpV4_c.hpp"
+#include "IpV6_c.hpp"
+#include "utils.hpp"
+#include "IpPoolSort.hpp"
+#include "FilterKernels.hpp"
+#include "IpWriter_c.hpp"
+
+
+
+namespace {
+
+// Distributions of generated addresses, the second benchmark argument.
+enum dist_e : int64_t
+{
+    UNIFORM,     // all keys are equally likely
+    CLUSTERED,   // a few /16 subnets: long runs of equal first bytes
+    DUPLICATES,  // a few thousands of unique addresses repeated
+};
+
+ip_pool_t gen_ip_pool(size_t qty, int64_t dist = UNIFORM)
+{
+    std::mt19937 gen {42};
+    std::uniform_int_distribution<uint32_t> any {};
+    std::vector<uint32_t> population;
+    if (dist == CLUSTERED)  { for (size_t i = 0; i < 16; ++i)   { population.push_back(any(gen) & 0xFFFF0000u); } }
+    if (dist == DUPLICATES) { for (size_t i = 0; i < 4096; ++i) { population.push_back(any(gen)); } }
+    std::uniform_int_distribution<size_t> pick {0, population.empty() ? 0 : population.size() - 1};
+
+    ip_pool_t ip_pool;
+    ip_pool.reserve(qty);
+    for (size_t i = 0; i < qty; ++i)
+    {
+        uint32_t key = any(gen);
+        if (dist == CLUSTERED)  { key = population[pick(gen)] | (key & 0xFFFFu); }
+        if (dist == DUPLICATES) { key = population[pick(gen)]; }
+        ip_pool.push_back(IpV4_c::from_key(key));
+    }
+    return ip_pool;
+}
+
+std::vector<std::string> gen_ip_strings(size_t qty, int64_t dist = UNIFORM)
+{
+    std::vector<std::string> ips;
+    ips.reserve(qty);
+    for (const IpV4_c& ip : gen_ip_pool(qty, dist)) { ips.push_back(ip.toString()); }
+    return ips;
+}
+
+size_t total_size(const std::vector<std::string>& strs)
+{
+    size_t size = 0;
+    for (const std::string& str : strs) { size += str.size(); }
+    return size;
+}
+
+void set_processed(benchmark::State& state, size_t items, size_t bytes)
+{
+    state.SetItemsProcessed(state.iterations() * items);
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+constexpr size_t IPS_QTY = 1 << 16;
+
+// The parser which was used by IpV4_c::assign before the one-pass one.
+std::array<uint8_t, 4> legacy_parse(const std::string& str_ipv4)
+{
+    std::array<uint8_t, 4> bytes;
+    std::vector<std::string> parts = split(str_ipv4, '.');
+    if (parts.size() != bytes.size()) { throw std::runtime_error(str_ipv4); }
+    for (size_t i = 0; i < bytes.size(); ++i)
+    {
+        const std::string& part = parts[i];
+        auto[ptr, ec] = std::from_chars(part.c_str(), part.c_str() + part.size(), bytes[i]);
+        if (ec != std::errc()) { throw std::runtime_error(str_ipv4); }
+    }
+    return bytes;
+}
+
+} // namespace
+
+
+
+static void BM_split(benchmark::State& state)
+{
+    const std::vector<std::string> ips = gen_ip_strings(IPS_QTY, state.range(0));
+    for (auto _ : state)
+    {
+        for (const std::string& ip : ips) { benchmark::DoNotOptimize(split(ip, '.')); }
+    }
+    set_processed(state, ips.size(), total_size(ips));
+}
+BENCHMARK(BM_split)->ArgName("dist")->DenseRange(UNIFORM, DUPLICATES);
+
+
+static void BM_splitView(benchmark::State& state)
+{
+    const std::vector<std::string> ips = gen_ip_strings(IPS_QTY, state.range(0));
+    for (auto _ : state)
+    {
+        for (const std::string& ip : ips)
+        {
+            for (std::string_view field : split_view(ip, '.')) { benchmark::DoNotOptimize(field); }
+        }
+    }
+    set_processed(state, ips.size(), total_size(ips));
+}
+BENCHMARK(BM_splitView)->ArgName("dist")->DenseRange(UNIFORM, DUPLICATES);
+
+
+// The first column of a TSV line, as the reader needs it.
+static void BM_firstColumn_split(benchmark::State& state)
+{
+    std::vector<std::string> lines = gen_ip_strings(IPS_QTY);
+    for (std::string& line : lines) { line += "\tsome text\t12345"; }
+    for (auto _ : state)
+    {
+        for (const std::string& line : lines) { benchmark::DoNotOptimize(split(line, '\t').front()); }
+    }
+    set_processed(state, lines.size(), total_size(lines));
+}
+BENCHMARK(BM_firstColumn_split);
+
+
+static void BM_firstColumn_splitView(benchmark::State& state)
+{
+    std::vector<std::string> lines = gen_ip_strings(IPS_QTY);
+    for (std::string& line : lines) { line += "\tsome text\t12345"; }
+    for (auto _ : state)
+    {
+        for (const std::string& line : lines) { benchmark::DoNotOptimize(split_view(line, '\t').front()); }
+    }
+    set_processed(state, lines.size(), total_size(lines));
+}
+BENCHMARK(BM_firstColumn_splitView);
+
+
+static void BM_assign_legacySplit(benchmark::State& state)
+{
+    const std::vector<std::string> ips = gen_ip_strings(IPS_QTY, state.range(0));
+    for (auto _ : state)
+    {
+        for (const std::string& ip : ips) { benchmark::DoNotOptimize(legacy_parse(ip)); }
+    }
+    set_processed(state, ips.size(), total_size(ips));
+}
+BENCHMARK(BM_assign_legacySplit)->ArgName("dist")->DenseRange(UNIFORM, DUPLICATES);
+
+
+static void BM_assign_throwing(benchmark::State& state)
+{
+    const std::vector<std::string> ips = gen_ip_strings(IPS_QTY, state.range(0));
+    IpV4_c ip;
+    for (auto _ : state)
+    {
+        for (const std::string& str : ips) { ip.assign(str); benchmark::DoNotOptimize(ip); }
+    }
+    set_processed(state, ips.size(), total_size(ips));
+}
+BENCHMARK(BM_assign_throwing)->ArgName("dist")->DenseRange(UNIFORM, DUPLICATES);
+
+
+static void BM_assign_errc(benchmark::State& state)
+{
+    const std::vector<std::string> ips = gen_ip_strings(IPS_QTY, state.range(0));
+    IpV4_c ip;
+    for (auto _ : state)
+    {
+        for (const std::string& str : ips)
+        {
+            benchmark::DoNotOptimize(ip.try_assign(str));
+        }
+    }
+    set_processed(state, ips.size(), total_size(ips));
+}
+BENCHMARK(BM_assign_errc)->ArgName("dist")->DenseRange(UNIFORM, DUPLICATES);
+
+
+
+//NOTE: the sizes and distributions of the sort and filter benchmarks
+static void SizesAndDists(benchmark::internal::Benchmark* bench)
+{
+    bench->ArgNames({"size", "dist"})
+         ->ArgsProduct({{1'000'000, 10'000'000}, {UNIFORM, CLUSTERED, DUPLICATES}})
+         ->Unit(benchmark::kMillisecond);
+}
+
+
+static void BM_sort_std(benchmark::State& state)
+{
+    const ip_pool_t ip_pool = gen_ip_pool(state.range(0), state.range(1));
+    ip_pool_t pool;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        pool = ip_pool;
+        state.ResumeTiming();
+        std::sort(pool.rbegin(), pool.rend());
+        benchmark::DoNotOptimize(pool.data());
+    }
+    set_processed(state, ip_pool.size(), ip_pool.size() * sizeof(IpV4_c));
+}
+BENCHMARK(BM_sort_std)->Apply(SizesAndDists);
+BENCHMARK(BM_sort_std)->Args({100'000'000, UNIFORM})->Unit(benchmark::kMillisecond);
+
+
+static void BM_sort_radix(benchmark::State& state)
+{
+    const ip_pool_t ip_pool = gen_ip_pool(state.range(0), state.range(1));
+    ip_pool_t pool;
+    ip_pool_t scratch;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        pool = ip_pool;
+        state.ResumeTiming();
+        utils::radix_sort(pool, scratch, utils::sort_order_e::DESC);
+        benchmark::DoNotOptimize(pool.data());
+    }
+    set_processed(state, ip_pool.size(), ip_pool.size() * sizeof(IpV4_c));
+}
+BENCHMARK(BM_sort_radix)->Apply(SizesAndDists);
+BENCHMARK(BM_sort_radix)->Args({100'000'000, UNIFORM})->Unit(benchmark::kMillisecond);
+
+
+
+static void BM_sort_radix6(benchmark::State& state)
+{
+    std::mt19937_64 gen {42};
+    std::uniform_int_distribution<uint64_t> any {};
+    ip6_pool_t ip_pool;
+    for (int64_t i = 0; i < state.range(0); ++i)
+    {
+        //NOTE: a common /32 prefix like in real logs
+        ip_pool.push_back(IpV6_c::from_key(IpV6_c::key_t{0x20010db8u} << 96 | any(gen)));
+    }
+    ip6_pool_t pool;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        pool = ip_pool;
+        state.ResumeTiming();
+        utils::radix_sort(pool, utils::sort_order_e::DESC);
+        benchmark::DoNotOptimize(pool.data());
+    }
+    set_processed(state, ip_pool.size(), ip_pool.size() * sizeof(IpV6_c));
+}
+BENCHMARK(BM_sort_radix6)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
+
+
+
+static void BM_filter(benchmark::State& state)
+{
+    ip_pool_t ip_pool = gen_ip_pool(state.range(0), state.range(1));
+    //NOTE: the first bytes of the clustered pool, so that the filter matches
+    const IpV4_c::mask_t mask = {ip_pool.front().byte(0), ip_pool.front().byte(1),
+                                 IpV4_c::MATCH_SKIP_BYTE, IpV4_c::MATCH_SKIP_BYTE};
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(utils::filter(ip_pool, mask));
+    }
+    set_processed(state, ip_pool.size(), ip_pool.size() * sizeof(IpV4_c));
+}
+BENCHMARK(BM_filter)->Apply(SizesAndDists);
+
+
+static void BM_filterAny(benchmark::State& state)
+{
+    ip_pool_t ip_pool = gen_ip_pool(state.range(0), state.range(1));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(utils::filter_any(ip_pool, 46));
+    }
+    set_processed(state, ip_pool.size(), ip_pool.size() * sizeof(IpV4_c));
+}
+BENCHMARK(BM_filterAny)->Apply(SizesAndDists);
+
+
+
+template <kernels::isa_e ISA>
+static void BM_kernel_matchMask(benchmark::State& state)
+{
+    if (not kernels::is_supported(ISA)) { state.SkipWithError("unsupported ISA"); return; }
+    const ip_pool_t ip_pool = gen_ip_pool(state.range(0));
+    std::vector<uint32_t> idx(ip_pool.size());
+    const kernels::mask_key_s mk = kernels::make_mask_key({46, 70, IpV4_c::MATCH_SKIP_BYTE, IpV4_c::MATCH_SKIP_BYTE});
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kernels::match_mask(
+            ISA, kernels::keys_of(ip_pool.data()), ip_pool.size(), mk, idx.data()));
+    }
+    set_processed(state, ip_pool.size(), ip_pool.size() * sizeof(IpV4_c));
+}
+BENCHMARK_TEMPLATE(BM_kernel_matchMask, kernels::isa_e::SCALAR)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_kernel_matchMask, kernels::isa_e::SSE2)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_kernel_matchMask, kernels::isa_e::AVX2)->Arg(1 << 20);
+
+
+template <kernels::isa_e ISA>
+static void BM_kernel_matchAnyByte(benchmark::State& state)
+{
+    if (not kernels::is_supported(ISA)) { state.SkipWithError("unsupported ISA"); return; }
+    const ip_pool_t ip_pool = gen_ip_pool(state.range(0));
+    std::vector<uint32_t> idx(ip_pool.size());
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kernels::match_any_byte(
+            ISA, kernels::keys_of(ip_pool.data()), ip_pool.size(), 46, idx.data()));
+    }
+    set_processed(state, ip_pool.size(), ip_pool.size() * sizeof(IpV4_c));
+}
+BENCHMARK_TEMPLATE(BM_kernel_matchAnyByte, kernels::isa_e::SCALAR)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_kernel_matchAnyByte, kernels::isa_e::SSE2)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_kernel_matchAnyByte, kernels::isa_e::AVX2)->Arg(1 << 20);
+
+
+
+// Prints to /dev/null: the bytes are the size of the text output.
+static void BM_print_ostream(benchmark::State& state)
+{
+    const ip_pool_t ip_pool = gen_ip_pool(state.range(0), state.range(1));
+    size_t out_size = 0;
+    for (const IpV4_c& ip : ip_pool) { out_size += ip.toString().size() + 1; }
+
+    std::ofstream null {"/dev/null"};
+    for (auto _ : state)
+    {
+        for (const IpV4_c& ip : ip_pool) { null << ip << '\n'; }
+        null.flush();
+    }
+    set_processed(state, ip_pool.size(), out_size);
+}
+BENCHMARK(BM_print_ostream)->Args({1'000'000, UNIFORM})->Unit(benchmark::kMillisecond);
+
+
+// Prints to /dev/null: the bytes are the size of the text output.
+static void BM_print_writer(benchmark::State& state)
+{
+    const ip_pool_t ip_pool = gen_ip_pool(state.range(0), state.range(1));
+    size_t out_size = 0;
+    for (const IpV4_c& ip : ip_pool) { out_size += ip.toString().size() + 1; }
+
+    const int null = ::open("/dev/null", O_WRONLY);
+    for (auto _ : state)
+    {
+        IpWriter_c out {null};
+        utils::print(ip_pool, out);
+        out.flush();
+    }
+    ::close(null);
+    set_processed(state, ip_pool.size(), out_size);
+}
+BENCHMARK(BM_print_writer)->Apply(SizesAndDists);
+
+
+
+BENCHMARK_MAIN();
@@ -1,50 +1,611 @@
 #include <iostream>
 #include <algorithm>
+#include <string_view>
+#include <thread>
+#include <charconv>
+#include <cstdio>
 
 #include "IpV4_c.hpp"
-#include "utils.hpp"
+#include "IpV6_c.hpp"
+#include "IpPoolReader.hpp"
+#include "IpPoolSort.hpp"
+#include "IpPoolParallel.hpp"
+#include "QueryBatch_c.hpp"
+#include "SortedIpIndex_c.hpp"
+#include "IpWriter_c.hpp"
+#include "IpCounter_c.hpp"
+#include "ExternalSorter_c.hpp"
+#include "IpPoolSnapshot.hpp"
+#include "StreamFilter_c.hpp"
+#include "StageStats_c.hpp"
 
+#include "common/stdex/exception.hpp"
 
 
-ip_pool_t make_ip_pool()
+
+namespace {
+
+struct ArgParser
 {
+    ArgParser(int argc, char** argv)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string_view arg {argv[i]};
+            if (arg == "--input")
+            {
+                if (++i == argc) { throw stdex::exception("missing value of [--input]"); }
+                m_input_path = argv[i];
+            }
+            else if (arg == "--threads")
+            {
+                if (++i == argc) { throw stdex::exception("missing value of [--threads]"); }
+                //NOTE: a thread is started per part, more threads than cores only add overhead
+                m_threads = std::min(ToNumber(argv[i]), MaxThreads());
+                if (0 == m_threads) { m_threads = MaxThreads(); }
+            }
+            else if (arg == "--dedup")
+            {
+                m_dedup = true;
+            }
+            else if (arg == "--top")
+            {
+                if (++i == argc) { throw stdex::exception("missing value of [--top]"); }
+                m_top = ToNumber(argv[i]);
+                if (0 == m_top) { throw stdex::exception("invalid value [0] of [--top]: K has to be positive"); }
+            }
+            else if (arg == "--mem-limit")
+            {
+                if (++i == argc) { throw stdex::exception("missing value of [--mem-limit]"); }
+                m_mem_limit = ToSize(argv[i]);
+            }
+            else if (arg == "--save-pool")
+            {
+                if (++i == argc) { throw stdex::exception("missing value of [--save-pool]"); }
+                m_save_pool_path = argv[i];
+            }
+            else if (arg == "--load-pool")
+            {
+                if (++i == argc) { throw stdex::exception("missing value of [--load-pool]"); }
+                m_load_pool_path = argv[i];
+            }
+            else if (arg == "--compress")
+            {
+                m_compress = true;
+            }
+            else if (arg == "--stream")
+            {
+                m_stream = true;
+            }
+            else if (arg == "--unsorted")
+            {
+                m_unsorted = true;
+            }
+            else if (arg == "--mixed")
+            {
+                m_mixed = true;
+            }
+            else if (arg == "--stats" || arg == "--stats-json")
+            {
+#ifndef ENABLE_STATS
+                throw stdex::exception("[%s] is disabled at build time (IP_FILTER_STATS)", argv[i]);
+#endif
+                m_stats      = true;
+                m_stats_json = (arg == "--stats-json");
+            }
+            else
+            {
+                throw stdex::exception("unexpected argument [%s]", argv[i]);
+            }
+        }
+
+        if (m_load_pool_path && m_input_path)
+        {
+            throw stdex::exception("[--load-pool] can't be used with [--input]");
+        }
+        //NOTE: every mode has its own pipeline, so they can't be combined
+        const int modes = (m_dedup || m_top != 0) + (m_mem_limit != 0) + m_stream
+                        + (m_load_pool_path || m_save_pool_path) + m_mixed;
+        if (modes > 1)
+        {
+            throw stdex::exception("only one of [--dedup]/[--top], [--mem-limit], [--stream], "
+                                   "[--save-pool]/[--load-pool] and [--mixed] can be used");
+        }
+        if (m_unsorted && not m_stream)
+        {
+            throw stdex::exception("[--unsorted] can be used with [--stream] only");
+        }
+    }
+
+    // nullptr means stdin
+    const char* InputPath() const noexcept { return m_input_path; }
+    size_t      Threads()   const noexcept { return m_threads; }
+    bool        Dedup()     const noexcept { return m_dedup; }
+    // 0 means all addresses
+    size_t      Top()       const noexcept { return m_top; }
+    // 0 means no limit
+    size_t      MemLimit()  const noexcept { return m_mem_limit; }
+    // nullptr means no snapshot
+    const char* SavePoolPath() const noexcept { return m_save_pool_path; }
+    const char* LoadPoolPath() const noexcept { return m_load_pool_path; }
+    bool        Compress()     const noexcept { return m_compress; }
+    bool        Stream()       const noexcept { return m_stream; }
+    bool        Unsorted()     const noexcept { return m_unsorted; }
+    bool        Mixed()        const noexcept { return m_mixed; }
+    bool        Stats()        const noexcept { return m_stats; }
+    bool        StatsJson()    const noexcept { return m_stats_json; }
+
+    static char const* Usage() noexcept
+    {
+        return "Usage: ip_filter [--input FILE] [--threads N] [--dedup] [--top K]\n"
+               "                 [--mem-limit SIZE] [--save-pool FILE [--compress]]\n"
+               "                 [--load-pool FILE] [--stream [--unsorted]] [--mixed]\n"
+               "                 [--stats | --stats-json]\n"
+               "    --input FILE    read FILE (memory mapped) instead of stdin\n"
+               "    --threads N     parse, sort and filter by N threads (0 - all cores),\n"
+               "                    at most by the number of cores\n"
+               "    --dedup         print unique addresses with their hit counts\n"
+               "    --top K         print K most frequent addresses with their hit counts\n"
+               "    --mem-limit SIZE\n"
+               "                    sort by runs of SIZE bytes (suffixes K, M, G) spilled\n"
+               "                    to temporary files, for inputs larger than memory\n"
+               "    --save-pool FILE\n"
+               "                    save the sorted pool to a binary snapshot FILE\n"
+               "    --compress      delta-encode and varint-compress the snapshot\n"
+               "    --load-pool FILE\n"
+               "                    read the pool from a snapshot FILE instead of text\n"
+               "    --stream        print the filtered addresses only, keeping the matches\n"
+               "                    but not the whole input in memory\n"
+               "    --unsorted      print the matches as soon as a block of 1024 lines is\n"
+               "                    filtered: the queries are interleaved block by block\n"
+               "    --mixed         accept IPv6 addresses too: the same queries are run on\n"
+               "                    them and printed after the IPv4 output, the leading\n"
+               "                    bytes of a query are a /8 or /16 prefix\n"
+               "    --stats         print wall and CPU time, items, bytes and peak RSS of\n"
+               "                    every stage to stderr\n"
+               "    --stats-json    the same as JSON";
+    }
+
+private:
+    // The number of cores or a fixed cap if it's unknown.
+    static size_t MaxThreads() noexcept
+    {
+        constexpr size_t UNKNOWN_CORES_THREADS = 16;
+        const unsigned cores = std::thread::hardware_concurrency();
+        return (cores != 0) ? cores : UNKNOWN_CORES_THREADS;
+    }
+
+    static size_t ToNumber(std::string_view arg)
+    {
+        size_t number = 0;
+        auto[ptr, ec] = std::from_chars(arg.begin(), arg.end(), number);
+        if (ec != std::errc())
+        {
+            throw stdex::exception(
+                "Can't convert argument [%.*s] to a number: %s",
+                (int)arg.size(), arg.data(),
+                std::make_error_code(ec).message().c_str());
+        }
+        else if (ptr != arg.end())
+        {
+            throw stdex::exception(
+                "Can't convert argument [%.*s] to a number: "
+                "[%s] is not the tail of the number",
+                (int)arg.size(), arg.data(), ptr);
+        }
+        return number;
+    }
+
+    // A number of bytes with an optional binary suffix: K, M or G.
+    static size_t ToSize(std::string_view arg)
+    {
+        const std::string_view size_arg = arg;
+        size_t shift = 0;
+        if (not arg.empty())
+        {
+            switch (arg.back())
+            {
+                case 'K': shift = 10; break;
+                case 'M': shift = 20; break;
+                case 'G': shift = 30; break;
+            }
+            if (shift != 0) { arg.remove_suffix(1); }
+        }
+        const size_t number = ToNumber(arg);
+        if (number > (SIZE_MAX >> shift))
+        {
+            throw stdex::exception("Can't convert argument [%.*s] to a size: it's too big",
+                                   (int)size_arg.size(), size_arg.data());
+        }
+        return number << shift;
+    }
+
+    const char*    m_input_path     = nullptr;
+    size_t         m_threads        = 1;
+    bool           m_dedup          = false;
+    size_t         m_top            = 0;
+    size_t         m_mem_limit      = 0;
+    const char*    m_save_pool_path = nullptr;
+    const char*    m_load_pool_path = nullptr;
+    bool           m_compress       = false;
+    bool           m_stream         = false;
+    bool           m_unsorted       = false;
+    bool           m_mixed          = false;
+    bool           m_stats          = false;
+    bool           m_stats_json     = false;
+};
+
+
+// `info` is filled if the pool is loaded from a snapshot, `ip6_pool` if the
+// input is a mixed one.
+ip_pool_t make_ip_pool(const ArgParser& args, utils::snapshot_info_s& info, ip6_pool_t& ip6_pool)
+{
+    STATS_SCOPE("parse");
     ip_pool_t ip_pool;
-    for(std::string line; std::getline(std::cin, line);)
+    if (const char* path = args.LoadPoolPath())
+    {
+        ip_pool = utils::load_ip_pool(path, &info);
+        STATS_BYTES_IN(info.file_size);
+    }
+    else if (args.Mixed())
+    {
+        mixed_ip_pools_s pools;
+        if (const char* path = args.InputPath())
+        {
+            MappedFile_c file {path};
+            pools = utils::make_mixed_ip_pools(file.view());
+            STATS_BYTES_IN(file.view().size());
+        }
+        else
+        {
+            size_t bytes_read = 0;
+            pools = utils::make_mixed_ip_pools(stdin, &bytes_read);
+            STATS_BYTES_IN(bytes_read);
+        }
+        ip6_pool = std::move(pools.v6);
+        ip_pool  = std::move(pools.v4);
+    }
+    else if (const char* path = args.InputPath())
+    {
+        MappedFile_c file {path};
+        ip_pool = (args.Threads() > 1)
+            ? utils::make_ip_pool(file.view(), args.Threads())
+            : utils::make_ip_pool(file.view());
+        STATS_BYTES_IN(file.view().size());
+    }
+    else if (args.Threads() > 1)
+    {
+        size_t bytes_read = 0;
+        ip_pool = utils::make_ip_pool(stdin, args.Threads(), &bytes_read);
+        STATS_BYTES_IN(bytes_read);
+    }
+    else
     {
-        std::vector<std::string> columns = split(line, '\t');
-        ip_pool.emplace_back(columns.at(0));
+        size_t bytes_read = 0;
+        ip_pool = utils::make_ip_pool(stdin, &bytes_read);
+        STATS_BYTES_IN(bytes_read);
     }
+    STATS_ITEMS(ip_pool.size() + ip6_pool.size());
     return ip_pool;
 }
 
 
-int main()
+// Calls `on_column(std::string_view)` with the first column of every line
+// of the input without keeping it in memory. Returns the size of the input.
+template <typename F>
+size_t for_each_input_column(const ArgParser& args, F&& on_column)
 {
-    try
+    if (const char* path = args.InputPath())
     {
-        ip_pool_t ip_pool = make_ip_pool();
+        MappedFile_c file {path};
+        utils::for_each_first_column_eof(file.view(), on_column);
+        return file.view().size();
+    }
+    return utils::read_first_columns(stdin, on_column);
+}
 
-        std::sort(ip_pool.rbegin(), ip_pool.rend());
 
-        utils::print(ip_pool);
+// The filters of the task in the order of the output.
+QueryBatch_c make_queries()
+{
+    constexpr int SKIP = IpV4_c::MATCH_SKIP_BYTE;
+    QueryBatch_c queries;
+    queries.add_mask({1, SKIP, SKIP, SKIP});
+    queries.add_mask({46, 70, SKIP, SKIP});
+    queries.add_any_byte(46);
+    return queries;
+}
 
-        using mask_t = IpV4_c::mask_t;
-        mask_t mask;
-        std::fill(mask.begin(), mask.end(), IpV4_c::MATCH_SKIP_BYTE);
 
-        mask[0] = 1;
-        utils::print(utils::filter(ip_pool, mask));
+// Counts hits without keeping every line: the memory depends on the number
+// of unique addresses only.
+void print_counts(const ArgParser& args, IpWriter_c& out)
+{
+    IpCounter_c counter;
+    {
+        STATS_SCOPE("count");
+        const size_t bytes_read = for_each_input_column(args, [&](std::string_view column)
+        {
+            counter.add(IpV4_c{column});
+        });
+        STATS_BYTES_IN(bytes_read);
+        STATS_ITEMS(counter.hits());
+    }
 
-        mask[0] = 46; mask[1] = 70;
-        utils::print(utils::filter(ip_pool, mask));
+    std::vector<IpCount_s> counts;
+    {
+        STATS_SCOPE("sort counts");
+        counts = counter.counts();
+        if (args.Top() != 0) { utils::top_k(counts, args.Top()); }
+        else                 { utils::sort(counts, utils::sort_order_e::DESC); }
+        STATS_ITEMS(counter.size());
+    }
 
-        utils::print(utils::filter_any(ip_pool, 46));
+    STATS_SCOPE("print counts");
+    STATS_ITEMS(counts.size());
+    STATS_OUTPUT(out);
+    utils::print(counts, out);
+}
+
+
+// The same output as the in-memory path, but the input is sorted by an
+// external sort and the query matches are spilled to temporary files.
+void print_external(const ArgParser& args, IpWriter_c& out)
+{
+    ExternalSorter_c sorter {args.MemLimit() / (2 * sizeof(IpV4_c)), utils::sort_order_e::DESC};
+    {
+        STATS_SCOPE("parse and spill");
+        const size_t bytes_read = for_each_input_column(args, [&](std::string_view column)
+        {
+            sorter.add(IpV4_c{column});
+        });
+        STATS_BYTES_IN(bytes_read);
+        STATS_ITEMS(sorter.size());
     }
-    catch(const std::exception &e)
+
+    const QueryBatch_c queries = make_queries();
+
+    std::vector<KeyFile_c> matches(queries.size());
+    {
+        STATS_SCOPE("merge and filter");
+        STATS_OUTPUT(out);
+        QueryBatch_c::results_t results;
+        sorter.merge([&](ip_pool_t& block)
+        {
+            STATS_ITEMS(block.size());
+            utils::print(block, out);
+            results.clear();
+            queries.run(block, 0, block.size(), results);
+            for (size_t q = 0; q < results.size(); ++q)
+            {
+                for (const IpV4_c& ip : results[q]) { matches[q].write(ip); }
+            }
+        });
+    }
+
+    STATS_SCOPE("print matches");
+    STATS_OUTPUT(out);
+    uint32_t keys[ExternalSorter_c::BLOCK_SIZE];
+    for (KeyFile_c& match : matches)
+    {
+        match.rewind();
+        for (size_t n; (n = match.read(keys, std::size(keys))) != 0; )
+        {
+            STATS_ITEMS(n);
+            for (size_t i = 0; i < n; ++i) { out.write(IpV4_c::from_key(keys[i])); }
+        }
+    }
+}
+
+
+
+// The filter part of the output without the sorted pool: the parsed
+// addresses go straight to the filters and only the matches are kept.
+// Unsorted matches are printed and flushed block by block of the input, so
+// the matches of different queries are interleaved: every block gives the
+// matches of the first query, then of the second one and so on.
+void print_stream(const ArgParser& args, IpWriter_c& out)
+{
+    const QueryBatch_c queries = make_queries();
+    std::vector<ip_pool_t> matches(queries.size());
     {
-        std::cerr << e.what() << std::endl;
+        STATS_SCOPE("stream filter");
+        STATS_OUTPUT(out);
+        auto on_matches = [&](size_t query, const filtered_ip_pool_t& block_matches)
+        {
+            if (args.Unsorted()) { utils::print(block_matches, out); return; }
+            for (const IpV4_c& ip : block_matches) { matches[query].push_back(ip); }
+        };
+
+        StreamFilter_c filter {queries, on_matches};
+        const size_t bytes_read = for_each_input_column(args, [&](std::string_view column)
+        {
+            if (filter.add(IpV4_c{column}) && args.Unsorted()) { out.flush(); }
+        });
+        filter.flush();
+        STATS_BYTES_IN(bytes_read);
+        STATS_ITEMS(filter.size());
+    }
+
+    STATS_SCOPE("sort and print");
+    STATS_OUTPUT(out);
+    for (ip_pool_t& match : matches)
+    {
+        STATS_ITEMS(match.size());
+        utils::radix_sort(match, utils::sort_order_e::DESC);
+        utils::print(match, out);
+    }
+}
+
+
+// The output of the task for the IPv6 addresses of a mixed input: the
+// leading bytes of the queries are prefixes of the sorted pool.
+void print_sorted_ipv6(ip6_pool_t& ip6_pool, IpWriter_c& out)
+{
+    {
+        STATS_SCOPE("sort ipv6");
+        STATS_ITEMS(ip6_pool.size());
+        utils::radix_sort(ip6_pool, utils::sort_order_e::DESC);
+    }
+    {
+        STATS_SCOPE("print ipv6");
+        STATS_ITEMS(ip6_pool.size());
+        STATS_OUTPUT(out);
+        utils::print(ip6_pool, out);
+    }
+
+    using key_t = IpV6_c::key_t;
+    auto print_prefix = [&](const char* filter_stage, const char* print_stage, key_t prefix, unsigned prefix_len)
+    {
+        IpV6Span_c span;
+        {
+            STATS_SCOPE(filter_stage);
+            span = utils::prefix_range(ip6_pool, utils::sort_order_e::DESC, IpV6_c::from_key(prefix), prefix_len);
+            STATS_ITEMS(span.size());
+        }
+        STATS_SCOPE(print_stage);
+        STATS_ITEMS(span.size());
+        STATS_OUTPUT(out);
+        utils::print(span, out);
+    };
+
+    print_prefix("filter ipv6 1", "print ipv6 1", key_t{1} << 120, 8);
+    print_prefix("filter ipv6 46.70", "print ipv6 46.70", key_t{0x2e46} << 112, 16);
+
+    filtered_ip6_pool_t any;
+    {
+        STATS_SCOPE("filter ipv6 any 46");
+        STATS_ITEMS(ip6_pool.size());
+        any = utils::filter_any(ip6_pool, 46);
+    }
+    STATS_SCOPE("print ipv6 any 46");
+    STATS_ITEMS(any.size());
+    STATS_OUTPUT(out);
+    utils::print(any, out);
+}
+
+
+// The whole output of the task by the sorted pool in memory.
+void print_sorted(const ArgParser& args, IpWriter_c& out)
+{
+    const size_t threads = args.Threads();
+
+    utils::snapshot_info_s info;
+    ip6_pool_t ip6_pool;
+    ip_pool_t ip_pool = make_ip_pool(args, info, ip6_pool);
+
+    if (not info.sorted || info.order != utils::sort_order_e::DESC)
+    {
+        STATS_SCOPE("sort");
+        STATS_ITEMS(ip_pool.size());
+        if (threads > 1) { utils::parallel_sort(ip_pool, utils::sort_order_e::DESC, threads); }
+        else             { utils::radix_sort(ip_pool, utils::sort_order_e::DESC); }
+    }
+    if (const char* path = args.SavePoolPath())
+    {
+        STATS_SCOPE("save pool");
+        STATS_ITEMS(ip_pool.size());
+        utils::save_ip_pool(ip_pool, path, args.Compress());
+    }
+
+    {
+        STATS_SCOPE("print pool");
+        STATS_ITEMS(ip_pool.size());
+        STATS_OUTPUT(out);
+        utils::print(ip_pool, out);
     }
 
-    return 0;
+    //NOTE: prefix masks are answered by the index without scans,
+    //      other queries are evaluated by one pass over the pool
+    const SortedIpIndex_c index {ip_pool, utils::sort_order_e::DESC};
+
+    using mask_t = IpV4_c::mask_t;
+    mask_t mask;
+    std::fill(mask.begin(), mask.end(), IpV4_c::MATCH_SKIP_BYTE);
+
+    auto print_prefix = [&](const char* filter_stage, const char* print_stage, const mask_t& prefix_mask)
+    {
+        IpSpan_c span;
+        {
+            STATS_SCOPE(filter_stage);
+            span = index.prefix_range(prefix_mask);
+            STATS_ITEMS(span.size());
+        }
+        STATS_SCOPE(print_stage);
+        STATS_ITEMS(span.size());
+        STATS_OUTPUT(out);
+        utils::print(span, out);
+    };
+
+    mask[0] = 1;
+    print_prefix("filter 1", "print 1", mask);
+
+    mask[0] = 46; mask[1] = 70;
+    print_prefix("filter 46.70", "print 46.70", mask);
+
+    QueryBatch_c queries;
+    queries.add_any_byte(46);
+
+    QueryBatch_c::results_t results;
+    {
+        STATS_SCOPE("filter any 46");
+        STATS_ITEMS(ip_pool.size());
+        results = (threads > 1)
+            ? utils::parallel_run(queries, ip_pool, threads)
+            : queries.run(ip_pool);
+    }
+    for (const filtered_ip_pool_t& result : results)
+    {
+        STATS_SCOPE("print any 46");
+        STATS_ITEMS(result.size());
+        STATS_OUTPUT(out);
+        utils::print(result, out);
+    }
+
+    if (not ip6_pool.empty()) { print_sorted_ipv6(ip6_pool, out); }
 }
 
+} // namespace
+
+
+
+int main(int argc, char* argv[])
+{
+    //NOTE: the output goes through IpWriter_c, iostreams are for errors only
+    std::ios::sync_with_stdio(false);
+
+    int ret_code = 0;
+    try
+    {
+        ArgParser args {argc, argv};
+#ifdef ENABLE_STATS
+        if (args.Stats())
+        {
+            using format_e = StageStats_c::format_e;
+            StageStats_c::instance().enable(args.StatsJson() ? format_e::JSON : format_e::TEXT);
+        }
+#endif
+
+        IpWriter_c out;
+        if (args.Dedup() || args.Top() != 0) { print_counts(args, out); }
+        else if (args.Stream())              { print_stream(args, out); }
+        else if (args.MemLimit() != 0)       { print_external(args, out); }
+        else                                 { print_sorted(args, out); }
+        {
+            STATS_SCOPE("flush");
+            out.flush();
+        }
+
+#ifdef ENABLE_STATS
+        if (args.Stats()) { StageStats_c::instance().report(stderr); }
+#endif
+    }
+    catch(const std::exception &e)
+    {
+        std::cerr << "Fatal error: " << e.what() << "\n\n"
+                  << ArgParser::Usage() << '\n';
+        ret_code = 1;
+    }
+
+    return ret_code;
+}
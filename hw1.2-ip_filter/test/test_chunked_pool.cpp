@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+#include "ChunkedIpPool_c.hpp"
+#include "IpPoolReader.hpp"
+#include "IpPoolSort.hpp"
+
+
+
+TEST(ChunkedIpPool, pushAndRelease)
+{
+    //NOTE: a few chunks and a partial one
+    const size_t qty = 3 * ChunkedIpPool_c::CHUNK_SIZE + 5;
+    std::mt19937 gen {7};
+    ip_pool_t exp;
+    ChunkedIpPool_c chunked_pool;
+    EXPECT_TRUE(chunked_pool.empty());
+    for (size_t i = 0; i < qty; ++i)
+    {
+        const IpV4_c ip = IpV4_c::from_key(gen());
+        exp.push_back(ip);
+        chunked_pool.push_back(ip);
+    }
+    ASSERT_EQ(qty, chunked_pool.size());
+    EXPECT_EQ(exp.back(), chunked_pool[qty - 1]);
+    EXPECT_TRUE(std::equal(exp.cbegin(), exp.cend(), chunked_pool.begin(), chunked_pool.end()));
+
+    //NOTE: the iterators are random-access ones
+    std::sort(exp.begin(), exp.end());
+    std::sort(chunked_pool.begin(), chunked_pool.end());
+    EXPECT_EQ(exp, chunked_pool.release());
+    EXPECT_TRUE(chunked_pool.empty());
+}
+
+
+
+TEST(ChunkedIpPool, makeIpPool)
+{
+    EXPECT_EQ(0u, utils::count_lines(""));
+    EXPECT_EQ(1u, utils::count_lines("1.2.3.4"));
+    EXPECT_EQ(2u, utils::count_lines("1.2.3.4\n5.6.7.8\n"));
+    EXPECT_EQ(3u, utils::count_lines("\n\n1"));
+
+    const char text[] = "1.2.3.4\tx\n5.6.7.8\ty\n9.10.11.12";
+    FILE* stream = fmemopen(const_cast<char*>(text), sizeof(text) - 1, "r");
+    ASSERT_NE(nullptr, stream);
+    const ip_pool_t exp = {IpV4_c{"1.2.3.4"}, IpV4_c{"5.6.7.8"}, IpV4_c{"9.10.11.12"}};
+    EXPECT_EQ(exp, utils::make_ip_pool(stream));
+    fclose(stream);
+    EXPECT_EQ(exp, utils::make_ip_pool(std::string_view{text}));
+}
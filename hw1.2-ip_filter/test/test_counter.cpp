@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <stdexcept>
+
+#include "IpV4_c.hpp"
+#include "IpCounter_c.hpp"
+#include "IpPoolReader.hpp"
+
+
+
+TEST(IpCounter, sameAsMap)
+{
+    std::mt19937 gen {3};
+    //NOTE: a lot of duplicates and the zero key, which isn't an empty slot
+    std::uniform_int_distribution<uint32_t> dist {0, 50'000};
+    IpCounter_c counter;
+    std::map<uint32_t, uint32_t> exp;
+    for (size_t i = 0; i < 300'000; ++i)
+    {
+        const uint32_t key = dist(gen) * 0x10001u;
+        counter.add(IpV4_c::from_key(key));
+        ++exp[key];
+    }
+    counter.add(IpV4_c::from_key(0), 7);
+    exp[0] += 7;
+
+    ASSERT_EQ(exp.size(), counter.size());
+    EXPECT_EQ(300'000u + 7u, counter.hits());
+    for (const auto& [key, count] : exp)
+    {
+        ASSERT_EQ(count, counter.count(IpV4_c::from_key(key))) << key;
+    }
+    EXPECT_EQ(0u, counter.count(IpV4_c{"255.255.255.255"}));
+
+    std::vector<IpCount_s> counts = counter.counts();
+    utils::sort(counts, utils::sort_order_e::ASC);
+    ASSERT_EQ(exp.size(), counts.size());
+    auto it = exp.cbegin();
+    for (size_t i = 0; i < counts.size(); ++i, ++it)
+    {
+        ASSERT_EQ(it->first,  counts[i].ip.key()) << "Index " << i;
+        ASSERT_EQ(it->second, counts[i].count)    << "Index " << i;
+    }
+
+    IpCounter_c twice {counter.size()};
+    twice.merge(counter);
+    twice.merge(counter);
+    ASSERT_EQ(counter.size(), twice.size());
+    for (const auto& [key, count] : exp)
+    {
+        ASSERT_EQ(2 * count, twice.count(IpV4_c::from_key(key))) << key;
+    }
+}
+
+
+
+TEST(IpCounter, overflow)
+{
+    IpCounter_c counter;
+    counter.add(IpV4_c{"1.2.3.4"}, UINT32_MAX);
+    EXPECT_THROW(counter.add(IpV4_c{"1.2.3.4"}), std::overflow_error);
+    EXPECT_EQ(UINT32_MAX, counter.count(IpV4_c{"1.2.3.4"}));
+}
+
+
+
+TEST(IpCounter, topK)
+{
+    IpCounter_c counter;
+    utils::for_each_first_column_eof(
+        "1.1.1.1\ta\n2.2.2.2\tb\n1.1.1.1\tc\n3.3.3.3\n2.2.2.2\n4.4.4.4\n1.1.1.1\n5.5.5.5",
+        [&counter](std::string_view column) { counter.add(IpV4_c{column}); });
+
+    std::vector<IpCount_s> counts = counter.counts();
+    utils::top_k(counts, 3);
+    ASSERT_EQ(3u, counts.size());
+    EXPECT_EQ("1.1.1.1", counts[0].ip.toString()); EXPECT_EQ(3u, counts[0].count);
+    EXPECT_EQ("2.2.2.2", counts[1].ip.toString()); EXPECT_EQ(2u, counts[1].count);
+    //NOTE: the ties are ordered by the address descending
+    EXPECT_EQ("5.5.5.5", counts[2].ip.toString()); EXPECT_EQ(1u, counts[2].count);
+
+    counts = counter.counts();
+    utils::top_k(counts, 100);
+    EXPECT_EQ(5u, counts.size());
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include "IpV4_c.hpp"
+#include "IpPoolSort.hpp"
+#include "ExternalSorter_c.hpp"
+#include "test_utils.hpp"
+
+
+
+TEST(KeyFile, writeRead)
+{
+    KeyFile_c file;
+    const uint32_t keys[] = { 0, 1, UINT32_MAX, 0x01020304u };
+    file.write(keys, std::size(keys));
+    file.write(IpV4_c{"5.6.7.8"});
+    EXPECT_EQ(5u, file.size());
+
+    file.rewind();
+    uint32_t read[8] = {};
+    ASSERT_EQ(5u, file.read(read, std::size(read)));
+    EXPECT_TRUE(std::equal(std::begin(keys), std::end(keys), read));
+    EXPECT_EQ(IpV4_c{"5.6.7.8"}.key(), read[4]);
+    EXPECT_EQ(0u, file.read(read, std::size(read)));
+}
+
+
+
+TEST(ExternalSorter, sameAsRadixSort)
+{
+    const ip_pool_t ip_pool = test_utils::gen_ip_pool(10'000, 17);
+    //NOTE: a single run in memory, a few merge passes and runs with a tail
+    for (size_t run_size : {size_t{100'000}, size_t{7}, size_t{999}})
+    {
+        for (utils::sort_order_e order : {utils::sort_order_e::ASC, utils::sort_order_e::DESC})
+        {
+            ExternalSorter_c sorter {run_size, order};
+            for (const IpV4_c& ip : ip_pool) { sorter.add(ip); }
+            EXPECT_EQ(ip_pool.size(), sorter.size());
+            if (run_size > ip_pool.size()) { EXPECT_EQ(0u, sorter.runs()); }
+            //NOTE: the runs are merged by levels while they are spilled,
+            //      1428 runs of the size 7 have 3 levels
+            else { EXPECT_LT(sorter.runs(), 3 * ExternalSorter_c::MAX_MERGE_WAYS); }
+
+            ip_pool_t sorted;
+            sorter.merge([&sorted](ip_pool_t& block)
+            {
+                ASSERT_LE(block.size(), ExternalSorter_c::BLOCK_SIZE);
+                sorted.insert(sorted.end(), block.cbegin(), block.cend());
+            });
+
+            ip_pool_t exp = ip_pool;
+            utils::radix_sort(exp, order);
+            ASSERT_EQ(exp, sorted) << "Run size " << run_size;
+        }
+    }
+}
+
+
+
+TEST(ExternalSorter, runsByLevels)
+{
+    constexpr size_t WAYS = ExternalSorter_c::MAX_MERGE_WAYS;
+    ExternalSorter_c sorter {1, utils::sort_order_e::ASC};
+    //NOTE: the number of runs is the sum of the digits of the number of
+    //      spilled runs in base MAX_MERGE_WAYS
+    for (uint32_t key = 0; key < WAYS * WAYS + 2 * WAYS + 3; ++key)
+    {
+        sorter.add(IpV4_c::from_key(key));
+        ASSERT_LT(sorter.runs(), 3 * WAYS);
+    }
+    EXPECT_EQ(1u + 2u + 3u, sorter.runs());
+
+    uint32_t exp_key = 0;
+    sorter.merge([&exp_key](ip_pool_t& block)
+    {
+        for (const IpV4_c& ip : block) { ASSERT_EQ(exp_key++, ip.key()); }
+    });
+    EXPECT_EQ(WAYS * WAYS + 2 * WAYS + 3, exp_key);
+}
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+#include "IpV6_c.hpp"
+#include "IpPoolSort.hpp"
+
+
+
+namespace {
+
+IpV6_c::key_t make_key(std::initializer_list<uint16_t> groups)
+{
+    IpV6_c::key_t key = 0;
+    for (uint16_t group : groups) { key = key << 16 | group; }
+    return key;
+}
+
+ip6_pool_t gen_ip6_pool(size_t qty)
+{
+    std::mt19937_64 gen {31};
+    //NOTE: a few common prefixes like in real logs
+    std::uniform_int_distribution<uint64_t> any;
+    std::uniform_int_distribution<int> prefix {0, 3};
+    ip6_pool_t ip_pool;
+    for (size_t i = 0; i < qty; ++i)
+    {
+        const IpV6_c::key_t hi = make_key({0x2001, 0x0db8, static_cast<uint16_t>(prefix(gen)), 0});
+        ip_pool.push_back(IpV6_c::from_key(hi << 64 | any(gen)));
+    }
+    return ip_pool;
+}
+
+} // namespace
+
+
+
+TEST(IpV6, parse)
+{
+    struct case_s { const char* str; IpV6_c::key_t key; };
+    const case_s cases[] = {
+        { "::",                             0 },
+        { "::1",                            1 },
+        { "1::",                            make_key({1, 0, 0, 0, 0, 0, 0, 0}) },
+        { "2001:db8::8:800:200c:417a",      make_key({0x2001, 0xdb8, 0, 0, 8, 0x800, 0x200c, 0x417a}) },
+        { "2001:DB8:0:0:8:800:200C:417A",   make_key({0x2001, 0xdb8, 0, 0, 8, 0x800, 0x200c, 0x417a}) },
+        { "ff01::101",                      make_key({0xff01, 0, 0, 0, 0, 0, 0, 0x101}) },
+        { "1:2:3:4:5:6:7:8",                make_key({1, 2, 3, 4, 5, 6, 7, 8}) },
+        { "1:2:3:4:5:6:7::",                make_key({1, 2, 3, 4, 5, 6, 7, 0}) },
+        { "::2:3:4:5:6:7:8",                make_key({0, 2, 3, 4, 5, 6, 7, 8}) },
+        { "::ffff:1.2.3.4",                 make_key({0, 0, 0, 0, 0, 0xffff, 0x0102, 0x0304}) },
+        { "1:2:3:4:5:6:255.0.10.100",       make_key({1, 2, 3, 4, 5, 6, 0xff00, 0x0a64}) },
+        { "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff", ~IpV6_c::key_t{0} },
+    };
+    for (const case_s& c : cases)
+    {
+        IpV6_c ip;
+        ASSERT_EQ(std::errc(), ip.try_assign(c.str)) << c.str;
+        EXPECT_TRUE(ip.key() == c.key) << c.str;
+    }
+
+    const char* wrong_ips[] = {
+        "", ":", ":::", "1", "1:", ":1", "1:::2", "1::2::3", "12345::", "g::",
+        "1:2:3:4:5:6:7", "1:2:3:4:5:6:7:8:9", "1:2:3:4:5:6:7:8::", "::1:2:3:4:5:6:7:8",
+        "::1.2.3", "::1.2.3.4:1", "1:2:3:4:5:6:7:1.2.3.4", "::256.0.0.0", "1.2.3.4", " ::1",
+    };
+    for (const char* wrong_ip : wrong_ips)
+    {
+        IpV6_c ip = IpV6_c::from_key(42);
+        EXPECT_EQ(std::errc::invalid_argument, ip.try_assign(wrong_ip)) << wrong_ip;
+        EXPECT_TRUE(ip.key() == 42) << wrong_ip;
+        EXPECT_THROW(IpV6_c{wrong_ip}, std::runtime_error) << wrong_ip;
+    }
+}
+
+
+
+TEST(IpV6, toString)
+{
+    const std::pair<const char*, const char*> cases[] = {
+        { "::",                                "::" },
+        { "::1",                               "::1" },
+        { "1::",                               "1::" },
+        { "2001:0DB8:0:0:8:800:200C:417A",     "2001:db8::8:800:200c:417a" },
+        { "1:0:0:2:0:0:0:3",                   "1:0:0:2::3" },
+        { "1:0:0:2:0:0:3:4",                   "1::2:0:0:3:4" },
+        { "1:0:2:3:4:5:6:7",                   "1:0:2:3:4:5:6:7" },
+        //NOTE: only IPv4-mapped addresses have the mixed notation
+        { "::ffff:102:304",                    "::ffff:1.2.3.4" },
+        { "0:0:0:0:0:FFFF:255.255.255.255",    "::ffff:255.255.255.255" },
+        { "::ffff:0.0.0.0",                    "::ffff:0.0.0.0" },
+        { "::1:ffff:1.2.3.4",                  "::1:ffff:102:304" },
+        { "::ffff:0:1.2.3.4",                  "::ffff:0:102:304" },
+        { "::1.2.3.4",                         "::102:304" },
+        { "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff", "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff" },
+    };
+    for (const auto& [str, exp] : cases)
+    {
+        const IpV6_c ip {str};
+        EXPECT_EQ(exp, ip.toString()) << str;
+        EXPECT_EQ(ip, IpV6_c{ip.toString()}) << str;
+    }
+}
+
+
+
+TEST(IpV6, matchAndFilter)
+{
+    const IpV6_c ip {"2001:db8::46"};
+    EXPECT_EQ(0x20, ip.byte(0));
+    EXPECT_EQ(0x46, ip.byte(15));
+    EXPECT_TRUE(ip.has_byte(0xb8));
+    EXPECT_FALSE(ip.has_byte(0x47));
+
+    IpV6_c::mask_t mask;
+    std::fill(mask.begin(), mask.end(), IpV6_c::MATCH_SKIP_BYTE);
+    mask[0] = 0x20; mask[1] = 0x01;
+    EXPECT_TRUE(ip.match(mask));
+    mask[15] = 0x47;
+    EXPECT_FALSE(ip.match(mask));
+
+    ip6_pool_t ip_pool = { IpV6_c{"2001:db8::46"}, IpV6_c{"::1"}, IpV6_c{"2001::"} };
+    auto to_pool = [](const filtered_ip6_pool_t& view) { return ip6_pool_t(view.begin(), view.end()); };
+    mask[15] = IpV6_c::MATCH_SKIP_BYTE;
+    EXPECT_EQ((ip6_pool_t{ip_pool[0], ip_pool[2]}), to_pool(utils::filter(ip_pool, mask)));
+    EXPECT_EQ((ip6_pool_t{ip_pool[0]}),             to_pool(utils::filter_any(ip_pool, 0xb8)));
+    EXPECT_EQ(ip_pool,                              to_pool(utils::filter_any(ip_pool, 1)));
+    //NOTE: the view refers to the addresses of the pool
+    EXPECT_EQ(&ip_pool[2], &*++utils::filter(ip_pool, mask).begin());
+}
+
+
+
+TEST(IpV6, radixSortAndPrefix)
+{
+    for (utils::sort_order_e order : {utils::sort_order_e::ASC, utils::sort_order_e::DESC})
+    {
+        ip6_pool_t ip_pool = gen_ip6_pool(10'000);
+        ip6_pool_t exp     = ip_pool;
+        if (order == utils::sort_order_e::ASC) { std::sort(exp.begin(), exp.end()); }
+        else { std::sort(exp.begin(), exp.end(), [](const IpV6_c& l, const IpV6_c& r) { return r < l; }); }
+        utils::radix_sort(ip_pool, order);
+        ASSERT_EQ(exp, ip_pool);
+
+        for (unsigned prefix_len : {0u, 32u, 48u, 64u, 127u, 128u})
+        {
+            const IpV6_c prefix = ip_pool[ip_pool.size() / 3];
+            const IpV6Span_c span = utils::prefix_range(ip_pool, order, prefix, prefix_len);
+            auto in_prefix = [&](const IpV6_c& ip)
+            {
+                return prefix_len == 0 || ((ip.key() ^ prefix.key()) >> (128 - prefix_len)) == 0;
+            };
+            const size_t exp_size = std::count_if(ip_pool.cbegin(), ip_pool.cend(), in_prefix);
+            ASSERT_EQ(exp_size, span.size()) << "Prefix " << prefix_len;
+            ASSERT_TRUE(std::all_of(span.begin(), span.end(), in_prefix)) << "Prefix " << prefix_len;
+        }
+    }
+}
+
+
+
+TEST(IpV6, mixedPools)
+{
+    const mixed_ip_pools_s pools = utils::make_mixed_ip_pools(
+        "1.2.3.4\tx\n2001:db8::1\ty\n::ffff:5.6.7.8\n9.10.11.12\r\n::1");
+    EXPECT_EQ((ip_pool_t{IpV4_c{"1.2.3.4"}, IpV4_c{"9.10.11.12"}}), pools.v4);
+    EXPECT_EQ((ip6_pool_t{IpV6_c{"2001:db8::1"}, IpV6_c{"::ffff:5.6.7.8"}, IpV6_c{"::1"}}), pools.v6);
+}
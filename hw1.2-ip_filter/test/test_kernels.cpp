@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "IpV4_c.hpp"
+#include "FilterKernels.hpp"
+#include "test_utils.hpp"
+
+
+
+namespace {
+
+constexpr int SKIP = IpV4_c::MATCH_SKIP_BYTE;
+
+const kernels::isa_e ALL_ISAS[] = {
+    kernels::isa_e::SCALAR,
+    kernels::isa_e::SSE2,
+    kernels::isa_e::AVX2,
+};
+
+} // namespace
+
+
+
+TEST(Kernels, makeMaskKey)
+{
+    using mk_t = kernels::mask_key_s;
+    auto check = [](const IpV4_c::mask_t& mask, mk_t exp)
+    {
+        mk_t act = kernels::make_mask_key(mask);
+        return act.value == exp.value && act.bitmask == exp.bitmask;
+    };
+    EXPECT_TRUE(check({ SKIP, SKIP, SKIP, SKIP }, mk_t{0, 0}));
+    EXPECT_TRUE(check({    1, SKIP, SKIP, SKIP }, mk_t{0x01000000, 0xFF000000}));
+    EXPECT_TRUE(check({ SKIP,    2, SKIP,  255 }, mk_t{0x000200FF, 0x00FF00FF}));
+    EXPECT_FALSE(kernels::make_mask_key({ 256, SKIP, SKIP, SKIP }).match(0));
+    EXPECT_FALSE(kernels::make_mask_key({  -5, SKIP, SKIP, SKIP }).match(0));
+}
+
+
+TEST(Kernels, matchMask)
+{
+    //NOTE: a small range of bytes to get a lot of matches
+    const ip_pool_t ip_pool = test_utils::gen_ip_pool(1031, 3, 0, 3);
+    std::vector<uint32_t> idx(ip_pool.size());
+    for (const IpV4_c::mask_t& mask : {
+            IpV4_c::mask_t{ SKIP, SKIP, SKIP, SKIP },
+            IpV4_c::mask_t{    1, SKIP, SKIP, SKIP },
+            IpV4_c::mask_t{ SKIP,    2, SKIP,    3 },
+            IpV4_c::mask_t{    0,    1,    2,    3 },
+            IpV4_c::mask_t{  100, SKIP, SKIP, SKIP },
+        })
+    {
+        std::vector<uint32_t> exp_idx;
+        for (size_t i = 0; i < ip_pool.size(); ++i)
+        {
+            if (ip_pool[i].match(mask)) { exp_idx.push_back(i); }
+        }
+        for (kernels::isa_e isa : ALL_ISAS)
+        {
+            if (not kernels::is_supported(isa)) { continue; }
+            //NOTE: different sizes to check the tails
+            for (size_t size : {ip_pool.size(), ip_pool.size() - 1, size_t{3}, size_t{0}})
+            {
+                size_t n = kernels::match_mask(
+                    isa, kernels::keys_of(ip_pool.data()), size,
+                    kernels::make_mask_key(mask), idx.data());
+                std::vector<uint32_t> part_exp_idx;
+                for (uint32_t i : exp_idx) { if (i < size) { part_exp_idx.push_back(i); } }
+                EXPECT_EQ(part_exp_idx, std::vector<uint32_t>(idx.begin(), idx.begin() + n))
+                    << "isa = " << static_cast<int>(isa) << " size = " << size;
+            }
+        }
+    }
+}
+
+
+TEST(Kernels, matchAnyByte)
+{
+    //NOTE: a small range of bytes to get a lot of matches
+    const ip_pool_t ip_pool = test_utils::gen_ip_pool(1031, 3, 0, 3);
+    std::vector<uint32_t> idx(ip_pool.size());
+    for (uint8_t byte : {0, 1, 3, 4})
+    {
+        std::vector<uint32_t> exp_idx;
+        for (size_t i = 0; i < ip_pool.size(); ++i)
+        {
+            if (ip_pool[i].has_byte(byte)) { exp_idx.push_back(i); }
+        }
+        for (kernels::isa_e isa : ALL_ISAS)
+        {
+            if (not kernels::is_supported(isa)) { continue; }
+            for (size_t size : {ip_pool.size(), ip_pool.size() - 1, size_t{3}, size_t{0}})
+            {
+                size_t n = kernels::match_any_byte(
+                    isa, kernels::keys_of(ip_pool.data()), size, byte, idx.data());
+                std::vector<uint32_t> part_exp_idx;
+                for (uint32_t i : exp_idx) { if (i < size) { part_exp_idx.push_back(i); } }
+                EXPECT_EQ(part_exp_idx, std::vector<uint32_t>(idx.begin(), idx.begin() + n))
+                    << "isa = " << static_cast<int>(isa) << " byte = " << (int)byte
+                    << " size = " << size;
+            }
+        }
+    }
+}
@@ -3,9 +3,20 @@
 #include <string>
 #include <stdexcept>
 #include <map>
+#include <random>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+
+#include <stdlib.h>  // mkstemp
+#include <unistd.h>  // pipe, write, close, unlink
 
 #include "IpV4_c.hpp"
+#include "IpPoolView_c.hpp"
 #include "utils.hpp"
+#include "IpPoolReader.hpp"
+#include "IpPoolSort.hpp"
 
 
 
@@ -48,11 +59,52 @@ TEST(IpV4, assignTooBigDigit_fail)
 }
 
 
+TEST(IpV4, tryAssign)
+{
+    IpV4_c ip {"1.2.3.4"};
+    EXPECT_EQ(std::errc(), ip.try_assign("255.0.10.100"));
+    EXPECT_EQ("255.0.10.100", ip.toString());
+
+    const std::vector<std::pair<std::string, std::errc>> wrong_ips = {
+        {"",               std::errc::invalid_argument},
+        {"1.2.3",          std::errc::invalid_argument},
+        {"1.2.3.4.5",      std::errc::invalid_argument},
+        {"1..3.4",         std::errc::invalid_argument},
+        {"1.2.3.4\t",      std::errc::invalid_argument},
+        {"-1.2.3.4",       std::errc::invalid_argument},
+        {"1.2.3.256",      std::errc::result_out_of_range},
+        {"1000.2.3.4",     std::errc::result_out_of_range},
+    };
+    for (const auto& [wrong_ip, exp_ec] : wrong_ips)
+    {
+        EXPECT_EQ(exp_ec, ip.try_assign(wrong_ip)) << wrong_ip;
+        EXPECT_EQ("255.0.10.100", ip.toString()) << wrong_ip;
+    }
+}
+
+
+TEST(IpV4, packedKey)
+{
+    const IpV4_c ip {"1.2.3.254"};
+    EXPECT_EQ(0x010203FEu, ip.key());
+    EXPECT_EQ(1,   ip.byte(0));
+    EXPECT_EQ(2,   ip.byte(1));
+    EXPECT_EQ(3,   ip.byte(2));
+    EXPECT_EQ(254, ip.byte(3));
+    EXPECT_EQ(ip, IpV4_c::from_key(ip.key()));
+    EXPECT_EQ("255.0.0.1", IpV4_c::from_key(0xFF000001u).toString());
+}
+
+
 TEST(IpV4, operatorLess_succ)
 {
     IpV4_c ip_1 {"1.2.3.4"};
     IpV4_c ip_2 {"1.2.3.5"};
     ASSERT_TRUE(ip_1 < ip_2) << "IpV4[" << ip_1 << "] < IpV4[" << ip_2 << "]";
+    ASSERT_FALSE(ip_2 < ip_1) << "IpV4[" << ip_2 << "] < IpV4[" << ip_1 << "]";
+    ASSERT_FALSE(ip_1 < ip_1) << "IpV4[" << ip_1 << "] < IpV4[" << ip_1 << "]";
+    ASSERT_TRUE(IpV4_c{"1.2.3.255"} < IpV4_c{"1.2.4.0"});
+    ASSERT_TRUE(IpV4_c{"127.255.255.255"} < IpV4_c{"128.0.0.0"});
 }
 
 
@@ -174,6 +226,38 @@ TEST(IpV4, sort)
 
 
 
+TEST(IpV4, radixSort)
+{
+    std::mt19937 gen {1};
+    std::uniform_int_distribution<uint32_t> dist {};
+    ip_pool_t ip_pool;
+    for (size_t i = 0; i < 10000; ++i)
+    {
+        //NOTE: some duplicates and some equal high bytes
+        ip_pool.push_back(IpV4_c::from_key(i % 3 ? dist(gen) : dist(gen) & 0x0A0000FF));
+    }
+
+    ip_pool_t scratch;
+    for (auto order : {utils::sort_order_e::ASC, utils::sort_order_e::DESC})
+    {
+        ip_pool_t exp_pool = ip_pool;
+        ip_pool_t act_pool = ip_pool;
+        if (order == utils::sort_order_e::ASC) { std::sort(exp_pool.begin(), exp_pool.end()); }
+        else                                   { std::sort(exp_pool.rbegin(), exp_pool.rend()); }
+        utils::radix_sort(act_pool, scratch, order);
+        ASSERT_EQ(exp_pool, act_pool);
+    }
+
+    ip_pool_t same_pool(100, IpV4_c{"1.2.3.4"});
+    utils::radix_sort(same_pool, utils::sort_order_e::DESC);
+    ASSERT_EQ(ip_pool_t(100, IpV4_c{"1.2.3.4"}), same_pool);
+
+    ip_pool_t empty_pool;
+    utils::radix_sort(empty_pool);
+    ASSERT_TRUE(empty_pool.empty());
+}
+
+
 TEST(Utils, filter)
 {
     constexpr int SKIP = IpV4_c::MATCH_SKIP_BYTE;
@@ -197,16 +281,18 @@ TEST(Utils, filter)
                       << "act=" << fp.size() << '\n';
             return false;
         }
-        for (size_t i = 0; i < fp.size(); ++i)
+        size_t i = 0;
+        for (const IpV4_c& ip : fp)
         {
-            if (exp_ips[i] != fp[i]->toString())
+            if (exp_ips[i] != ip.toString())
             {
                 std::cerr << "[line:" << lineno << "] "
                           << "Detected invalid IP #" << i << ": "
                           << "exp = [" << exp_ips[i] << "] "
-                          << "act = [" << fp[i]->toString() << "]\n";
+                          << "act = [" << ip.toString() << "]\n";
                 return false;
             }
+            ++i;
         }
         return true;
     };
@@ -261,16 +347,18 @@ TEST(Utils, filter_any)
                       << "act=" << fp.size() << '\n';
             return false;
         }
-        for (size_t i = 0; i < fp.size(); ++i)
+        size_t i = 0;
+        for (const IpV4_c& ip : fp)
         {
-            if (exp_ips[i] != fp[i]->toString())
+            if (exp_ips[i] != ip.toString())
             {
                 std::cerr << "[line:" << lineno << "] "
                           << "Detected invalid IP #" << i << ": "
                           << "exp = [" << exp_ips[i] << "] "
-                          << "act = [" << fp[i]->toString() << "]\n";
+                          << "act = [" << ip.toString() << "]\n";
                 return false;
             }
+            ++i;
         }
         return true;
     };
@@ -291,6 +379,58 @@ TEST(Utils, filter_any)
 }
 
 
+TEST(Utils, filteredView)
+{
+    ip_pool_t ip_pool(1000, IpV4_c{"1.2.3.4"});
+
+    //NOTE: sparse matches are kept as indices
+    filtered_ip_pool_t sparse {ip_pool};
+    sparse.push_back(3);
+    sparse.push_back(500);
+    EXPECT_FALSE(sparse.is_dense());
+    EXPECT_EQ(2, sparse.size());
+    std::vector<const IpV4_c*> act;
+    for (const IpV4_c& ip : sparse) { act.push_back(&ip); }
+    EXPECT_EQ((std::vector<const IpV4_c*>{&ip_pool[3], &ip_pool[500]}), act);
+
+    //NOTE: dense matches are kept as a bitmap
+    filtered_ip_pool_t dense {ip_pool};
+    for (uint32_t i = 0; i < ip_pool.size(); i += 3) { dense.push_back(i); }
+    EXPECT_TRUE(dense.is_dense());
+    EXPECT_EQ(334, dense.size());
+    EXPECT_LE(dense.memory_usage(), ip_pool.size() / 8 + 8);
+    size_t exp_idx = 0;
+    for (const IpV4_c& ip : dense)
+    {
+        ASSERT_EQ(&ip_pool[exp_idx], &ip);
+        exp_idx += 3;
+    }
+    EXPECT_EQ(1002, exp_idx);
+
+    filtered_ip_pool_t joined {ip_pool};
+    joined.push_back_range(0, 2);
+    filtered_ip_pool_t tail {ip_pool};
+    tail.push_back(999);
+    joined.append(tail);
+    filtered_ip_pool_t exp {ip_pool};
+    exp.push_back(0);
+    exp.push_back(1);
+    exp.push_back(999);
+    EXPECT_EQ(exp, joined);
+    EXPECT_NE(exp, sparse);
+
+    //NOTE: a view of a part of the pool is joined by its addresses
+    filtered_ip_pool_t part {ip_pool.data() + 500, 500};
+    part.push_back(499);
+    filtered_ip_pool_t whole {ip_pool};
+    whole.append(part);
+    ASSERT_EQ(1, whole.size());
+    EXPECT_EQ(&ip_pool[999], &*whole.begin());
+
+    EXPECT_EQ(filtered_ip_pool_t{}.begin(), filtered_ip_pool_t{}.end());
+}
+
+
 TEST(Utils, split)
 {
     using parts_t = std::vector<std::string>;
@@ -333,6 +473,141 @@ TEST(Utils, split)
 }
 
 
+TEST(Utils, splitView)
+{
+    using parts_t = std::vector<std::string_view>;
+    auto parts_of = [](SplitView_c view) { return parts_t(view.begin(), view.end()); };
+
+    EXPECT_EQ(parts_t({""}),                 parts_of(split_view(std::string_view{}, '.')));
+    EXPECT_EQ(parts_t({""}),                 parts_of(split_view("", '.')));
+    EXPECT_EQ(parts_t({"", "", ""}),         parts_of(split_view("..", '.')));
+    EXPECT_EQ(parts_t({"11", ""}),           parts_of(split_view("11.", '.')));
+    EXPECT_EQ(parts_t({"", "11"}),           parts_of(split_view(".11", '.')));
+    EXPECT_EQ(parts_t({"1.2.3", "1", "10"}), parts_of(split_view("1.2.3\t1\t10", '\t')));
+
+    //NOTE: the fields are views of the source string
+    const std::string str {"a b  c"};
+    SplitView_c view = split_view(str);
+    EXPECT_EQ(str.data() + 5, view.nth(3)->data());
+    EXPECT_EQ("a", view.front());
+    EXPECT_EQ("",  view.nth(2));
+    EXPECT_EQ("c", view.nth(3));
+    EXPECT_FALSE(view.nth(4).has_value());
+    EXPECT_EQ(4, std::distance(view.begin(), view.end()));
+
+    auto it = view.begin();
+    EXPECT_EQ("a", *it++);
+    EXPECT_EQ("b", *it);
+    EXPECT_EQ(1u, it->size());
+}
+
+
+
+TEST(Reader, forEachFirstColumn)
+{
+    std::vector<std::string> columns;
+    auto collect = [&columns](std::string_view column) { columns.emplace_back(column); };
+
+    const std::string text {"1.2.3.4\t1\t2\n5.6.7.8\r\n9.10.11.12\t3"};
+    size_t consumed = utils::for_each_first_column(text, collect);
+    EXPECT_EQ(text.find("9.10"), consumed);
+    ASSERT_EQ(2, columns.size());
+    EXPECT_EQ("1.2.3.4", columns[0]);
+    EXPECT_EQ("5.6.7.8", columns[1]);
+
+    columns.clear();
+    utils::for_each_first_column_eof(text, collect);
+    ASSERT_EQ(3, columns.size());
+    EXPECT_EQ("9.10.11.12", columns[2]);
+
+    //NOTE: an empty file is mapped as a view without data
+    columns.clear();
+    for (std::string_view empty : {std::string_view{}, std::string_view{""}})
+    {
+        EXPECT_EQ(0u, utils::for_each_first_column(empty, collect));
+        utils::for_each_first_column_eof(empty, collect);
+    }
+    EXPECT_TRUE(columns.empty());
+}
+
+
+TEST(Reader, makeIpPool)
+{
+    std::string text;
+    for (int i = 0; i < 100000; ++i)
+    {
+        text += "10.0." + std::to_string(i / 256 % 256) + '.' + std::to_string(i % 256) + "\t1\t2\n";
+    }
+
+    ip_pool_t from_view = utils::make_ip_pool(std::string_view{text});
+    ASSERT_EQ(100000, from_view.size());
+    EXPECT_EQ("10.0.0.0",   from_view.front().toString());
+    EXPECT_EQ("10.0.134.159", from_view.back().toString());
+
+    FILE* stream = fmemopen(text.data(), text.size(), "r");
+    ASSERT_NE(nullptr, stream);
+    ip_pool_t from_stream = utils::make_ip_pool(stream);
+    fclose(stream);
+    ASSERT_EQ(from_view.size(), from_stream.size());
+    for (size_t i = 0; i < from_view.size(); ++i)
+    {
+        ASSERT_FALSE(from_view[i] < from_stream[i] || from_stream[i] < from_view[i]) << i;
+    }
+
+    EXPECT_THROW(utils::make_ip_pool(std::string_view{"1.2.3.4\n1.2.3\n"}), std::runtime_error);
+
+    char path[] = "/tmp/ip_filter_empty_XXXXXX";
+    const int fd = mkstemp(path);
+    ASSERT_LE(0, fd);
+    close(fd);
+    {
+        MappedFile_c empty {path};
+        EXPECT_TRUE(utils::make_ip_pool(empty.view()).empty());
+    }
+    unlink(path);
+}
+
+
+
+
+TEST(Reader, readFirstColumnsOfPipe)
+{
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    FILE* stream = fdopen(fds[0], "r");
+    ASSERT_NE(nullptr, stream);
+
+    //NOTE: the writer keeps the pipe open until the first line is passed
+    //      on (or a timeout), so a reader waiting for the whole block sees
+    //      the line after the end of the input only
+    std::promise<void> first_column;
+    std::atomic<bool>  before_eof {false};
+    std::thread writer {[&]
+    {
+        const char line[] = "1.2.3.4\tx\n";
+        EXPECT_EQ(ssize_t{sizeof(line) - 1}, write(fds[1], line, sizeof(line) - 1));
+        if (first_column.get_future().wait_for(std::chrono::seconds(5)) == std::future_status::ready)
+        {
+            before_eof = true;
+        }
+        EXPECT_EQ(ssize_t{7}, write(fds[1], "5.6.7.8", 7));
+        close(fds[1]);
+    }};
+
+    std::vector<std::string> columns;
+    const size_t read = utils::read_first_columns(stream, [&](std::string_view column)
+    {
+        if (columns.empty()) { first_column.set_value(); }
+        columns.emplace_back(column);
+    });
+    writer.join();
+    fclose(stream);
+
+    EXPECT_TRUE(before_eof);
+    EXPECT_EQ(17u, read);
+    EXPECT_EQ((std::vector<std::string>{"1.2.3.4", "5.6.7.8"}), columns);
+}
+
 
 
 int main(int argc, char *argv[])
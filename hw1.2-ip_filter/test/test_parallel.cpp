@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <random>
+
+#include "IpV4_c.hpp"
+#include "IpPoolReader.hpp"
+#include "IpPoolSort.hpp"
+#include "IpPoolParallel.hpp"
+
+
+
+namespace {
+
+std::string gen_tsv(size_t lines)
+{
+    std::mt19937 gen {7};
+    std::uniform_int_distribution<int> dist {0, 255};
+    std::string text;
+    for (size_t i = 0; i < lines; ++i)
+    {
+        //NOTE: a lot of 1.x.x.x and 46.70.x.x to get non-empty filters
+        const int b0 = (i % 5 == 0) ? 1 : (i % 7 == 0) ? 46 : dist(gen);
+        const int b1 = (i % 7 == 0) ? 70 : dist(gen);
+        text += std::to_string(b0) + '.' + std::to_string(b1) + '.'
+              + std::to_string(dist(gen)) + '.' + std::to_string(dist(gen)) + "\t1\t2\n";
+    }
+    return text;
+}
+
+} // namespace
+
+
+
+TEST(Parallel, makeIpPool)
+{
+    const std::string text = gen_tsv(10007);
+    const ip_pool_t exp_pool = utils::make_ip_pool(std::string_view{text});
+    for (size_t threads : {1, 2, 3, 8, 64})
+    {
+        EXPECT_EQ(exp_pool, utils::make_ip_pool(text, threads)) << "threads = " << threads;
+    }
+    //NOTE: the last line without '\n' and more threads than lines
+    EXPECT_EQ(utils::make_ip_pool(std::string_view{"1.2.3.4\n5.6.7.8"}),
+              utils::make_ip_pool("1.2.3.4\n5.6.7.8", 16));
+    EXPECT_TRUE(utils::make_ip_pool("", 4).empty());
+}
+
+
+
+TEST(Parallel, makeIpPoolOfStream)
+{
+    //NOTE: a few batches of 1 MiB blocks
+    std::string text = gen_tsv(300'007);
+    const ip_pool_t exp_pool = utils::make_ip_pool(std::string_view{text});
+    for (size_t threads : {1, 2, 3})
+    {
+        for (bool eol : {true, false})
+        {
+            if (not eol) { text.pop_back(); }
+            FILE* stream = fmemopen(text.data(), text.size(), "r");
+            ASSERT_NE(nullptr, stream);
+            size_t bytes_read = 0;
+            EXPECT_EQ(exp_pool, utils::make_ip_pool(stream, threads, &bytes_read)) << "threads = " << threads;
+            EXPECT_EQ(text.size(), bytes_read);
+            fclose(stream);
+            if (not eol) { text.push_back('\n'); }
+        }
+    }
+
+    FILE* empty = fmemopen(text.data(), 0, "r");
+    ASSERT_NE(nullptr, empty);
+    EXPECT_TRUE(utils::make_ip_pool(empty, 4).empty());
+    fclose(empty);
+}
+
+
+TEST(Parallel, sort)
+{
+    const std::string text = gen_tsv(10007);
+    const ip_pool_t ip_pool = utils::make_ip_pool(std::string_view{text});
+    for (auto order : {utils::sort_order_e::ASC, utils::sort_order_e::DESC})
+    {
+        ip_pool_t exp_pool = ip_pool;
+        utils::radix_sort(exp_pool, order);
+        for (size_t threads : {1, 2, 3, 5, 8})
+        {
+            ip_pool_t act_pool = ip_pool;
+            utils::parallel_sort(act_pool, order, threads);
+            EXPECT_EQ(exp_pool, act_pool) << "threads = " << threads;
+        }
+    }
+}
+
+
+TEST(Parallel, filters)
+{
+    constexpr int SKIP = IpV4_c::MATCH_SKIP_BYTE;
+    const std::string text = gen_tsv(10007);
+    ip_pool_t ip_pool = utils::make_ip_pool(std::string_view{text});
+    utils::radix_sort(ip_pool, utils::sort_order_e::DESC);
+
+    for (size_t threads : {1, 2, 3, 8})
+    {
+        for (const IpV4_c::mask_t& mask : {
+                IpV4_c::mask_t{    1, SKIP, SKIP, SKIP },
+                IpV4_c::mask_t{   46,   70, SKIP, SKIP },
+                IpV4_c::mask_t{ SKIP, SKIP, SKIP, SKIP },
+            })
+        {
+            EXPECT_EQ(utils::filter(ip_pool, mask),
+                      utils::parallel_filter(ip_pool, mask, threads))
+                << "threads = " << threads;
+        }
+        EXPECT_EQ(utils::filter_any(ip_pool, 46),
+                  utils::parallel_filter_any(ip_pool, 46, threads))
+            << "threads = " << threads;
+    }
+
+    ip_pool_t empty_pool;
+    EXPECT_TRUE(utils::parallel_filter_any(empty_pool, 46, 4).empty());
+}
+
+
+TEST(Parallel, queryBatch)
+{
+    constexpr int SKIP = IpV4_c::MATCH_SKIP_BYTE;
+    const std::string text = gen_tsv(10007);
+    ip_pool_t ip_pool = utils::make_ip_pool(std::string_view{text});
+
+    QueryBatch_c queries;
+    queries.add_mask({ 1, SKIP, SKIP, SKIP });
+    queries.add_any_byte(46);
+    queries.add_mask({ 46, 70, SKIP, SKIP });
+    const QueryBatch_c::results_t exp_results = queries.run(ip_pool);
+    for (size_t threads : {1, 2, 3, 8})
+    {
+        const QueryBatch_c::results_t act_results = utils::parallel_run(queries, ip_pool, threads);
+        ASSERT_EQ(exp_results.size(), act_results.size());
+        for (size_t q = 0; q < exp_results.size(); ++q)
+        {
+            EXPECT_EQ(exp_results[q], act_results[q])
+                << "threads = " << threads << " query #" << q;
+        }
+    }
+}
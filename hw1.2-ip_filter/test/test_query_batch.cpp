@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include "IpV4_c.hpp"
+#include "QueryBatch_c.hpp"
+#include "StreamFilter_c.hpp"
+#include "test_utils.hpp"
+
+
+
+namespace {
+
+constexpr int SKIP = IpV4_c::MATCH_SKIP_BYTE;
+
+} // namespace
+
+
+
+TEST(QueryBatch, sameAsSeparateFilters)
+{
+    ip_pool_t ip_pool = test_utils::gen_ip_pool(5003, 11, 0, 99);
+
+    QueryBatch_c queries;
+    std::vector<filtered_ip_pool_t> exp_results;
+    for (const IpV4_c::mask_t& mask : {
+            IpV4_c::mask_t{    1, SKIP, SKIP, SKIP },
+            IpV4_c::mask_t{   46,   70, SKIP, SKIP },
+            IpV4_c::mask_t{ SKIP, SKIP, SKIP, SKIP },
+        })
+    {
+        EXPECT_EQ(exp_results.size(), queries.add_mask(mask));
+        exp_results.push_back(utils::filter(ip_pool, mask));
+    }
+    //NOTE: more than 64 any-byte queries to use several bitmap tables
+    for (int byte = 0; byte < 100; ++byte)
+    {
+        EXPECT_EQ(exp_results.size(), queries.add_any_byte(byte));
+        exp_results.push_back(utils::filter_any(ip_pool, byte));
+        if (byte == 46)
+        {
+            //NOTE: mixed kinds of queries
+            IpV4_c::mask_t mask { SKIP, 46, SKIP, 46 };
+            EXPECT_EQ(exp_results.size(), queries.add_mask(mask));
+            exp_results.push_back(utils::filter(ip_pool, mask));
+        }
+    }
+    ASSERT_EQ(exp_results.size(), queries.size());
+
+    const QueryBatch_c::results_t act_results = queries.run(ip_pool);
+    ASSERT_EQ(exp_results.size(), act_results.size());
+    for (size_t q = 0; q < exp_results.size(); ++q)
+    {
+        EXPECT_EQ(exp_results[q], act_results[q]) << "query #" << q;
+    }
+}
+
+
+TEST(QueryBatch, empty)
+{
+    ip_pool_t ip_pool = test_utils::gen_ip_pool(10, 11, 0, 99);
+    EXPECT_TRUE(QueryBatch_c{}.run(ip_pool).empty());
+
+    ip_pool_t empty_pool;
+    QueryBatch_c queries;
+    queries.add_any_byte(1);
+    queries.add_mask({ 1, SKIP, SKIP, SKIP });
+    const QueryBatch_c::results_t results = queries.run(empty_pool);
+    ASSERT_EQ(2, results.size());
+    EXPECT_TRUE(results[0].empty());
+    EXPECT_TRUE(results[1].empty());
+}
+
+
+
+TEST(StreamFilter, sameAsQueryBatch)
+{
+    ip_pool_t ip_pool = test_utils::gen_ip_pool(5003, 11, 0, 99);
+
+    QueryBatch_c queries;
+    queries.add_mask({ 1, SKIP, SKIP, SKIP });
+    queries.add_any_byte(46);
+    queries.add_mask({ 46, 70, SKIP, SKIP });
+    queries.add_any_byte(200);
+    const QueryBatch_c::results_t exp_results = queries.run(ip_pool);
+
+    std::vector<ip_pool_t> results(queries.size());
+    size_t calls = 0;
+    auto on_matches = [&](size_t query, const filtered_ip_pool_t& matches)
+    {
+        ++calls;
+        ASSERT_FALSE(matches.empty());
+        ASSERT_LE(matches.size(), StreamFilter_c::BLOCK_SIZE);
+        for (const IpV4_c& ip : matches) { results[query].push_back(ip); }
+    };
+    StreamFilter_c filter {queries, on_matches};
+    for (const IpV4_c& ip : ip_pool) { filter.add(ip); }
+    EXPECT_EQ(ip_pool.size(), filter.size());
+    filter.flush();
+    filter.flush();
+    EXPECT_EQ(ip_pool.size(), filter.size());
+
+    EXPECT_NE(0u, calls);
+    for (size_t q = 0; q < queries.size(); ++q)
+    {
+        ASSERT_EQ(exp_results[q].size(), results[q].size()) << "Query " << q;
+        EXPECT_TRUE(std::equal(results[q].cbegin(), results[q].cend(), exp_results[q].begin()))
+            << "Query " << q;
+    }
+    EXPECT_TRUE(results[3].empty());
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "IpV4_c.hpp"
+#include "IpPoolSort.hpp"
+#include "IpRangeSet_c.hpp"
+#include "SortedIpIndex_c.hpp"
+#include "test_utils.hpp"
+
+
+
+namespace {
+
+uint32_t key_of(const char* str) { return IpV4_c{str}.key(); }
+
+} // namespace
+
+
+
+TEST(IpRange, parse)
+{
+    EXPECT_EQ((IpRange_s{key_of("10.32.0.0"), key_of("10.63.255.255")}), IpRange_s::parse("10.32.0.0/11"));
+    EXPECT_EQ((IpRange_s{key_of("10.32.0.0"), key_of("10.63.255.255")}), IpRange_s::parse("10.47.1.2/11"));
+    EXPECT_EQ((IpRange_s{0, UINT32_MAX}),                                 IpRange_s::parse("1.2.3.4/0"));
+    EXPECT_EQ((IpRange_s{key_of("1.2.3.4"), key_of("1.2.3.4")}),          IpRange_s::parse("1.2.3.4/32"));
+    EXPECT_EQ((IpRange_s{key_of("1.2.3.4"), key_of("1.2.3.4")}),          IpRange_s::parse("1.2.3.4"));
+    EXPECT_EQ((IpRange_s{key_of("1.2.3.4"), key_of("5.6.7.8")}),          IpRange_s::parse("1.2.3.4-5.6.7.8"));
+
+    const char* wrong_ranges[] = {
+        "", "1.2.3.4/", "1.2.3.4/33", "1.2.3.4/-1", "1.2.3.4/1a", "1.2.3/8",
+        "1.2.3.4-", "5.6.7.8-1.2.3.4", "1.2.3.4-5.6.7", "1.2.3.4/8/8" };
+    for (const char* wrong_range : wrong_ranges)
+    {
+        IpRange_s range;
+        EXPECT_NE(std::errc(), IpRange_s::try_parse(wrong_range, range)) << wrong_range;
+        EXPECT_THROW(IpRange_s::parse(wrong_range), std::runtime_error) << wrong_range;
+    }
+}
+
+
+
+TEST(IpRangeSet, merge)
+{
+    const IpRangeSet_c set = IpRangeSet_c::parse(
+        "10.0.0.0/8,9.0.0.0-9.255.255.255,10.1.0.0/16,,1.1.1.1,1.1.1.3,1.1.1.2,"
+        "200.0.0.0-200.0.0.5,255.255.255.255,255.0.0.0/8");
+    const std::vector<IpRange_s> exp = {
+        { key_of("1.1.1.1"),   key_of("1.1.1.3")         },
+        { key_of("9.0.0.0"),   key_of("10.255.255.255")  },
+        { key_of("200.0.0.0"), key_of("200.0.0.5")       },
+        { key_of("255.0.0.0"), key_of("255.255.255.255") },
+    };
+    EXPECT_EQ(exp, set.ranges());
+
+    EXPECT_TRUE(set.contains(IpV4_c{"1.1.1.2"}));
+    EXPECT_TRUE(set.contains(IpV4_c{"10.20.30.40"}));
+    EXPECT_TRUE(set.contains(IpV4_c{"255.255.255.255"}));
+    EXPECT_FALSE(set.contains(IpV4_c{"1.1.1.4"}));
+    EXPECT_FALSE(set.contains(IpV4_c{"0.0.0.0"}));
+    EXPECT_FALSE(set.contains(IpV4_c{"200.0.0.6"}));
+    EXPECT_FALSE(IpRangeSet_c{}.contains(IpV4_c{"0.0.0.0"}));
+}
+
+
+
+TEST(IpRangeSet, sameAsScan)
+{
+    const std::vector<std::string> queries = {
+        "10.10.0.0/16",
+        "8.0.0.0/6,12.12.0.0/15",
+        "9.9.1.0/24,9.9.3.0/24,11.8.0.0-11.9.0.100,0.0.0.0,255.255.255.255",
+        "0.0.0.0/0",
+        "13.0.0.0/8",
+    };
+    for (utils::sort_order_e order : {utils::sort_order_e::ASC, utils::sort_order_e::DESC})
+    {
+        //NOTE: a few first bytes to get dense subnets
+        ip_pool_t ip_pool = test_utils::gen_sorted_ip_pool(100'000, order, 11, 8, 12, 2);
+        const SortedIpIndex_c index {ip_pool, order};
+        for (const std::string& query : queries)
+        {
+            const IpRangeSet_c set = IpRangeSet_c::parse(query);
+            std::vector<IpV4_c> exp;
+            for (const IpV4_c& ip : ip_pool)
+            {
+                if (set.contains(ip)) { exp.push_back(ip); }
+            }
+            const filtered_ip_pool_t f_pool = index.filter(set);
+            ASSERT_EQ(exp.size(), f_pool.size()) << query;
+            ASSERT_TRUE(std::equal(exp.cbegin(), exp.cend(), f_pool.begin())) << query;
+
+            const IpSpan_c span = index.range(set.ranges().front());
+            for (const IpV4_c& ip : span) { ASSERT_TRUE(set.ranges().front().contains(ip.key())); }
+        }
+    }
+}
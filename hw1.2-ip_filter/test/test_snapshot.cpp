@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include "IpV4_c.hpp"
+#include "IpPoolSort.hpp"
+#include "IpPoolSnapshot.hpp"
+#include "test_utils.hpp"
+
+
+
+namespace {
+
+// A random pool with the bounds and a duplicate key.
+ip_pool_t gen_ip_pool(size_t qty)
+{
+    ip_pool_t ip_pool = test_utils::gen_ip_pool(qty, 23);
+    ip_pool.push_back(IpV4_c{"0.0.0.0"});
+    ip_pool.push_back(IpV4_c{"255.255.255.255"});
+    ip_pool.push_back(IpV4_c{"255.255.255.255"});
+    return ip_pool;
+}
+
+// A temporary file path removed at the end of the test.
+struct temp_path_s
+{
+    temp_path_s() : path{std::string(::testing::TempDir()) + "ip_pool_snapshot.bin"} {}
+    ~temp_path_s() { std::remove(path.c_str()); }
+
+    std::string path;
+};
+
+} // namespace
+
+
+
+TEST(Snapshot, saveLoad)
+{
+    temp_path_s tmp;
+    const ip_pool_t unsorted = gen_ip_pool(10'000);
+    for (bool compress : {false, true})
+    {
+        utils::snapshot_info_s info = utils::save_ip_pool(unsorted, tmp.path.c_str(), compress);
+        EXPECT_FALSE(info.sorted);
+        EXPECT_FALSE(info.compressed);
+        EXPECT_EQ(unsorted, utils::load_ip_pool(tmp.path.c_str(), &info));
+        EXPECT_FALSE(info.sorted);
+
+        for (utils::sort_order_e order : {utils::sort_order_e::ASC, utils::sort_order_e::DESC})
+        {
+            ip_pool_t sorted = unsorted;
+            utils::radix_sort(sorted, order);
+            info = utils::save_ip_pool(sorted, tmp.path.c_str(), compress);
+            EXPECT_TRUE(info.sorted);
+            EXPECT_EQ(order, info.order);
+            EXPECT_EQ(compress, info.compressed);
+            const size_t file_size = info.file_size;
+
+            info = utils::snapshot_info_s{};
+            EXPECT_EQ(sorted, utils::load_ip_pool(tmp.path.c_str(), &info));
+            EXPECT_TRUE(info.sorted);
+            EXPECT_EQ(order, info.order);
+            EXPECT_EQ(compress, info.compressed);
+            EXPECT_EQ(file_size, info.file_size);
+            if (not compress) { EXPECT_EQ(24 + sorted.size() * sizeof(uint32_t), file_size); }
+        }
+    }
+
+    for (bool compress : {false, true})
+    {
+        EXPECT_NO_THROW(utils::save_ip_pool({}, tmp.path.c_str(), compress));
+        EXPECT_TRUE(utils::load_ip_pool(tmp.path.c_str()).empty());
+    }
+}
+
+
+
+TEST(Snapshot, invalid)
+{
+    temp_path_s tmp;
+    auto write_file = [&tmp](const std::string& content)
+    {
+        FILE* file = std::fopen(tmp.path.c_str(), "wb");
+        std::fwrite(content.data(), 1, content.size(), file);
+        std::fclose(file);
+    };
+
+    write_file("1.2.3.4\n");
+    EXPECT_THROW(utils::load_ip_pool(tmp.path.c_str()), std::runtime_error);
+
+    ip_pool_t ip_pool = gen_ip_pool(100);
+    utils::radix_sort(ip_pool);
+    utils::save_ip_pool(ip_pool, tmp.path.c_str(), true);
+    std::string content;
+    {
+        FILE* file = std::fopen(tmp.path.c_str(), "rb");
+        char buf[4096];
+        for (size_t n; (n = std::fread(buf, 1, sizeof(buf), file)) != 0; ) { content.append(buf, n); }
+        std::fclose(file);
+    }
+    write_file(content.substr(0, content.size() - 1));
+    EXPECT_THROW(utils::load_ip_pool(tmp.path.c_str()), std::runtime_error);
+
+    //NOTE: the last varint is not terminated
+    content.back() |= 0x80;
+    write_file(content);
+    EXPECT_THROW(utils::load_ip_pool(tmp.path.c_str()), std::runtime_error);
+
+    //NOTE: `count * sizeof(uint32_t)` wraps around to the payload size
+    utils::snapshot_header_s header;
+    header.count        = (uint64_t{1} << 62) + 1;
+    header.payload_size = sizeof(uint32_t);
+    content.assign(reinterpret_cast<const char*>(&header), sizeof(header));
+    content.append(sizeof(uint32_t), '\0');
+    write_file(content);
+    EXPECT_THROW(utils::load_ip_pool(tmp.path.c_str()), std::runtime_error);
+
+    auto write_snapshot = [&write_file](uint16_t flags, uint64_t count, const std::string& payload)
+    {
+        utils::snapshot_header_s header;
+        header.flags        = flags;
+        header.count        = count;
+        header.payload_size = payload.size();
+        write_file(std::string(reinterpret_cast<const char*>(&header), sizeof(header)) + payload);
+    };
+    const uint16_t compressed = utils::SNAPSHOT_SORTED | utils::SNAPSHOT_DELTA_VARINT;
+
+    //NOTE: the 5th byte of a varint has more than 32 bits
+    write_snapshot(compressed, 1, std::string("\xFF\xFF\xFF\xFF\x1F"));
+    EXPECT_THROW(utils::load_ip_pool(tmp.path.c_str()), std::runtime_error);
+
+    //NOTE: 255.255.255.255 plus 1 wraps around
+    write_snapshot(compressed, 2, std::string("\xFF\xFF\xFF\xFF\x0F\x01"));
+    EXPECT_THROW(utils::load_ip_pool(tmp.path.c_str()), std::runtime_error);
+    write_snapshot(compressed, 1, std::string("\xFF\xFF\xFF\xFF\x0F"));
+    EXPECT_EQ(ip_pool_t{IpV4_c{"255.255.255.255"}}, utils::load_ip_pool(tmp.path.c_str()));
+
+    EXPECT_THROW(utils::load_ip_pool("/nonexistent/snapshot"), std::system_error);
+}
+
+
+
+TEST(Snapshot, notSorted)
+{
+    temp_path_s tmp;
+    for (utils::sort_order_e order : {utils::sort_order_e::ASC, utils::sort_order_e::DESC})
+    {
+        ip_pool_t ip_pool = gen_ip_pool(100);
+        utils::radix_sort(ip_pool, order);
+        utils::save_ip_pool(ip_pool, tmp.path.c_str(), false);
+        EXPECT_EQ(ip_pool, utils::load_ip_pool(tmp.path.c_str()));
+
+        //NOTE: the first key of the raw payload is overwritten by the last one
+        utils::snapshot_header_s header;
+        FILE* file = std::fopen(tmp.path.c_str(), "r+b");
+        const uint32_t last = ip_pool.back().key();
+        std::fseek(file, sizeof(header), SEEK_SET);
+        std::fwrite(&last, sizeof(last), 1, file);
+        std::fclose(file);
+        EXPECT_THROW(utils::load_ip_pool(tmp.path.c_str()), std::runtime_error);
+    }
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include "IpV4_c.hpp"
+#include "IpPoolSort.hpp"
+#include "SortedIpIndex_c.hpp"
+#include "test_utils.hpp"
+
+
+
+namespace {
+
+constexpr int SKIP = IpV4_c::MATCH_SKIP_BYTE;
+
+const std::vector<IpV4_c::mask_t> MASKS = {
+    { SKIP, SKIP, SKIP, SKIP },
+    {    1, SKIP, SKIP, SKIP },
+    {    1,    2, SKIP, SKIP },
+    {    1,    2,    3, SKIP },
+    {    1,    2,    3,    4 },
+    {  255,  255,  255,  255 },
+    {    0,    0,    0,    0 },
+    {    9, SKIP, SKIP, SKIP },
+    {    1, SKIP,    3, SKIP },
+    {    1,    2, SKIP,    4 },
+    { SKIP,    2, SKIP, SKIP },
+    { SKIP,    2,    3, SKIP },
+    { SKIP, SKIP,    3, SKIP },
+    { SKIP, SKIP, SKIP,    4 },
+    {  300, SKIP, SKIP, SKIP },
+};
+
+} // namespace
+
+
+
+TEST(SortedIndex, isPrefix)
+{
+    EXPECT_TRUE(SortedIpIndex_c::is_prefix({ SKIP, SKIP, SKIP, SKIP }));
+    EXPECT_TRUE(SortedIpIndex_c::is_prefix({    1,    2, SKIP, SKIP }));
+    EXPECT_TRUE(SortedIpIndex_c::is_prefix({    1,    2,    3,    4 }));
+    EXPECT_FALSE(SortedIpIndex_c::is_prefix({ SKIP,   2, SKIP, SKIP }));
+    EXPECT_FALSE(SortedIpIndex_c::is_prefix({    1, SKIP,   3, SKIP }));
+}
+
+
+TEST(SortedIndex, sameAsFilter)
+{
+    for (auto order : {utils::sort_order_e::ASC, utils::sort_order_e::DESC})
+    {
+        //NOTE: a small range of bytes to get a lot of matches and duplicates
+        ip_pool_t ip_pool = test_utils::gen_sorted_ip_pool(20000, order, 5, 0, 5);
+        const SortedIpIndex_c index {ip_pool, order};
+        for (const IpV4_c::mask_t& mask : MASKS)
+        {
+            const filtered_ip_pool_t exp = utils::filter(ip_pool, mask);
+            EXPECT_EQ(exp, index.filter(mask))
+                << "order = " << static_cast<int>(order) << " mask = ["
+                << mask[0] << ',' << mask[1] << ',' << mask[2] << ',' << mask[3] << ']';
+            if (SortedIpIndex_c::is_prefix(mask))
+            {
+                const IpSpan_c span = index.prefix_range(mask);
+                ASSERT_EQ(exp.size(), span.size());
+                size_t i = 0;
+                for (const IpV4_c& ip : exp) { ASSERT_EQ(&ip, &span[i++]); }
+            }
+        }
+    }
+}
+
+
+TEST(SortedIndex, keyRange)
+{
+    for (auto order : {utils::sort_order_e::ASC, utils::sort_order_e::DESC})
+    {
+        //NOTE: a small range of bytes to get a lot of matches and duplicates
+        ip_pool_t ip_pool = test_utils::gen_sorted_ip_pool(5000, order, 5, 0, 5);
+        const SortedIpIndex_c index {ip_pool, order};
+        const uint32_t lo = IpV4_c{"1.2.0.0"}.key();
+        const uint32_t hi = IpV4_c{"3.0.5.1"}.key();
+        const IpSpan_c span = index.key_range(lo, hi);
+        size_t exp_size = 0;
+        for (const IpV4_c& ip : ip_pool) { exp_size += (lo <= ip.key() && ip.key() <= hi); }
+        EXPECT_EQ(exp_size, span.size());
+        for (const IpV4_c& ip : span) { EXPECT_TRUE(lo <= ip.key() && ip.key() <= hi); }
+        EXPECT_TRUE(index.key_range(hi, lo).empty());
+    }
+
+    ip_pool_t empty_pool;
+    const SortedIpIndex_c index {empty_pool, utils::sort_order_e::ASC};
+    EXPECT_TRUE(index.key_range(0, UINT32_MAX).empty());
+    EXPECT_TRUE(index.filter({ SKIP, 1, SKIP, SKIP }).empty());
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "StageStats_c.hpp"
+#include "IpWriter_c.hpp"
+
+
+
+namespace {
+
+std::string report(const StageStats_c& stats, StageStats_c::format_e format)
+{
+    FILE* file = tmpfile();
+    stats.report(file, format);
+    std::string text(static_cast<size_t>(ftell(file)), '\0');
+    rewind(file);
+    EXPECT_EQ(text.size(), fread(text.data(), 1, text.size(), file));
+    fclose(file);
+    return text;
+}
+
+} // namespace
+
+
+
+TEST(StageStats, disabled)
+{
+    StageStats_c stats;
+    {
+        StageScope_c scope {"parse", stats};
+        EXPECT_FALSE(scope.active());
+        scope.items(10);
+    }
+    EXPECT_TRUE(stats.stages().empty());
+}
+
+
+
+TEST(StageStats, scopes)
+{
+    StageStats_c stats;
+    stats.enable(StageStats_c::format_e::JSON);
+
+    const int fd = open("/dev/null", O_WRONLY);
+    ASSERT_NE(-1, fd);
+    {
+        IpWriter_c out {fd, 64};
+        {
+            StageScope_c scope {"parse", stats};
+            scope.items(2);
+            scope.items(3);
+            scope.bytes_in(42);
+        }
+        {
+            StageScope_c scope {"print", stats};
+            out.write(IpV4_c{"1.2.3.4"});
+            scope.output(out);
+            for (int i = 0; i < 10; ++i) { out.write(IpV4_c{"255.255.255.255"}); }
+        }
+    }
+    close(fd);
+
+    ASSERT_EQ(2u, stats.stages().size());
+    const stage_stats_s& parse = stats.stages()[0];
+    EXPECT_STREQ("parse", parse.name);
+    EXPECT_EQ(5u, parse.items);
+    EXPECT_EQ(42u, parse.bytes_in);
+    EXPECT_EQ(0u, parse.bytes_out);
+    EXPECT_GE(parse.wall_ms, 0);
+    EXPECT_GT(parse.peak_rss_kb, 0u);
+
+    const stage_stats_s& print = stats.stages()[1];
+    EXPECT_STREQ("print", print.name);
+    //NOTE: the flushed bytes are counted too, the bytes before output() aren't
+    EXPECT_EQ(10u * 16, print.bytes_out);
+
+    const std::string json = report(stats, StageStats_c::format_e::JSON);
+    EXPECT_EQ(0u, json.find("{\"stages\": ["));
+    EXPECT_NE(std::string::npos, json.find("\"name\": \"print\""));
+    EXPECT_NE(std::string::npos, json.find("\"bytes_out\": 160"));
+
+    const std::string text = report(stats, StageStats_c::format_e::TEXT);
+    EXPECT_EQ(0u, text.find("stage"));
+    EXPECT_NE(std::string::npos, text.find("\nparse "));
+    EXPECT_NE(std::string::npos, text.find("\nprint "));
+}
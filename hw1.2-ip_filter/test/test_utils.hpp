@@ -0,0 +1,50 @@
+#pragma once
+
+#include <random>
+
+#include <cstdint>
+
+#include "IpV4_c.hpp"
+#include "IpPoolSort.hpp"
+
+
+
+// Generators of test pools shared by the tests.
+namespace test_utils {
+
+// `qty` random addresses made by `seed`. The first `ranged_bytes` bytes of
+// every address are in [min_byte, max_byte] (a small range gives a lot of
+// matches and duplicates), the others are any.
+inline ip_pool_t gen_ip_pool(size_t qty, unsigned seed, uint32_t min_byte = 0,
+                             uint32_t max_byte = UINT8_MAX, size_t ranged_bytes = IpV4_c::BYTES_NUM)
+{
+    std::mt19937 gen {seed};
+    std::uniform_int_distribution<uint32_t> ranged {min_byte, max_byte};
+    std::uniform_int_distribution<uint32_t> any    {0, UINT8_MAX};
+    ip_pool_t ip_pool;
+    ip_pool.reserve(qty);
+    for (size_t i = 0; i < qty; ++i)
+    {
+        uint32_t key = 0;
+        for (size_t b = 0; b < IpV4_c::BYTES_NUM; ++b)
+        {
+            key = key << 8 | ((b < ranged_bytes) ? ranged(gen) : any(gen));
+        }
+        ip_pool.push_back(IpV4_c::from_key(key));
+    }
+    return ip_pool;
+}
+
+// The same pool plus the 0.0.0.0 and 255.255.255.255 bounds, sorted in `order`.
+inline ip_pool_t gen_sorted_ip_pool(size_t qty, utils::sort_order_e order, unsigned seed,
+                                    uint32_t min_byte = 0, uint32_t max_byte = UINT8_MAX,
+                                    size_t ranged_bytes = IpV4_c::BYTES_NUM)
+{
+    ip_pool_t ip_pool = gen_ip_pool(qty, seed, min_byte, max_byte, ranged_bytes);
+    ip_pool.push_back(IpV4_c{"255.255.255.255"});
+    ip_pool.push_back(IpV4_c{"0.0.0.0"});
+    utils::radix_sort(ip_pool, order);
+    return ip_pool;
+}
+
+} // namespace test_utils
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#include "IpV4_c.hpp"
+#include "IpWriter_c.hpp"
+
+
+
+namespace {
+
+// Reads back all which was written to the file.
+std::string read_back(FILE* file)
+{
+    std::fflush(file);
+    std::rewind(file);
+    std::string data;
+    char buf[4096];
+    for (size_t n; (n = std::fread(buf, 1, sizeof(buf), file)) != 0; )
+    {
+        data.append(buf, n);
+    }
+    return data;
+}
+
+} // namespace
+
+
+
+TEST(IpWriter, format)
+{
+    //NOTE: every byte value in every position
+    for (uint32_t v = 0; v < 256; ++v)
+    {
+        const uint32_t key = v << 24 | (255 - v) << 16 | (v * 7 % 256) << 8 | v;
+        const IpV4_c ip = IpV4_c::from_key(key);
+        char buf[IpWriter_c::MAX_IPV4_LEN];
+        const std::string exp = std::to_string(v) + '.' + std::to_string(255 - v) + '.'
+                              + std::to_string(v * 7 % 256) + '.' + std::to_string(v);
+        ASSERT_EQ(exp, std::string(buf, IpWriter_c::format(ip, buf)));
+    }
+}
+
+
+
+TEST(IpWriter, smallBuffer)
+{
+    FILE* file = std::tmpfile();
+    ASSERT_NE(nullptr, file);
+
+    const ip_pool_t ip_pool = {
+        IpV4_c{"255.255.255.255"}, IpV4_c{"0.0.0.0"}, IpV4_c{"1.10.100.200"} };
+    std::string exp;
+    {
+        //NOTE: the buffer is flushed on almost every write
+        IpWriter_c out {fileno(file), 1};
+        for (size_t i = 0; i < 100; ++i)
+        {
+            utils::print(ip_pool, out);
+            out.write("text");
+            out.write('\n');
+            for (const IpV4_c& ip : ip_pool) { exp += ip.toString() + '\n'; }
+            exp += "text\n";
+        }
+    }
+    EXPECT_EQ(exp, read_back(file));
+    std::fclose(file);
+}
@@ -2,8 +2,98 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
+#include <optional>
+#include <iterator>
+#include <cstring>  // memchr
 
 
 
 std::vector<std::string> split(const std::string& str, char d = ' ');
 
+
+
+// A lazy range of the fields of `str` separated by `d`. Yields the same
+// fields as split() but as views of `str`: nothing is allocated and the
+// next delimiter is looked for by memchr only when the iterator advances.
+class SplitView_c
+{
+public:
+    class iterator_c
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = std::string_view;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const std::string_view*;
+        using reference         = const std::string_view&;
+
+        iterator_c() = default;
+
+        reference operator*()  const noexcept { return m_field; }
+        pointer   operator->() const noexcept { return &m_field; }
+
+        iterator_c& operator++() noexcept
+        {
+            const char* const next = m_field.data() + m_field.size();
+            if (next == m_end) { m_field = {}; m_end = nullptr; }
+            else               { m_field = find(next + 1, m_end, m_d); }
+            return *this;
+        }
+        iterator_c operator++(int) noexcept { iterator_c it = *this; ++*this; return it; }
+
+        bool operator==(const iterator_c& r) const noexcept
+        {
+            return m_end == r.m_end && m_field.data() == r.m_field.data();
+        }
+        bool operator!=(const iterator_c& r) const noexcept { return not (*this == r); }
+
+    private:
+        friend class SplitView_c;
+
+        iterator_c(const char* first, const char* end, char d) noexcept
+            : m_field{find(first, end, d)}
+            , m_end{end}
+            , m_d{d}
+        {}
+
+        // The field from `first` till the delimiter or `end`.
+        static std::string_view find(const char* first, const char* end, char d) noexcept
+        {
+            const void* stop = memchr(first, d, end - first);
+            return {first, static_cast<size_t>((stop ? static_cast<const char*>(stop) : end) - first)};
+        }
+
+        // The end iterator has null m_end.
+        std::string_view    m_field;
+        const char*         m_end = nullptr;
+        char                m_d   = ' ';
+    };
+
+    SplitView_c(std::string_view str, char d) noexcept
+        //NOTE: an empty view may have no data, but it has one empty field
+        : m_str{str.data() ? str : std::string_view{""}}
+        , m_d{d}
+    {}
+
+    iterator_c begin() const noexcept { return {m_str.data(), m_str.data() + m_str.size(), m_d}; }
+    iterator_c end()   const noexcept { return {}; }
+
+    // The n-th field (from 0) if there is one. Stops scanning at it.
+    std::optional<std::string_view> nth(size_t n) const noexcept
+    {
+        iterator_c it = begin();
+        for (; n != 0 && it != end(); --n) { ++it; }
+        if (it == end()) { return std::nullopt; }
+        return *it;
+    }
+
+    // The first field, always exists.
+    std::string_view front() const noexcept { return *begin(); }
+
+private:
+    std::string_view    m_str;
+    char                m_d;
+};
+
+inline SplitView_c split_view(std::string_view str, char d = ' ') noexcept { return {str, d}; }
@@ -0,0 +1,114 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "custom_allocator.hpp"
+#include "concurrent_slab_arena.hpp"
+
+
+
+namespace {
+
+// A small node like the ones of std::list or std::map.
+struct node_s
+{
+    node_s*    next;
+    size_t     value;
+};
+
+constexpr size_t BATCH_SIZE = 64;
+
+// The allocator shared by all benchmark threads.
+template <typename Alloc>
+Alloc& shared_alloc()
+{
+    static Alloc alloc;
+    return alloc;
+}
+
+// Producer threads (even ones) hand batches of nodes over to consumer
+// threads (odd ones) which free them.
+struct channel_s
+{
+    std::mutex                          mutex;
+    std::vector<std::vector<node_s*>>   batches;
+};
+
+std::array<channel_s, 64> g_channels;
+
+} // namespace
+
+
+
+// Every thread allocates and frees a list of its own.
+template <typename Alloc>
+void BM_listPushClear(benchmark::State& state)
+{
+    using list_alloc_t = typename std::allocator_traits<Alloc>::template rebind_alloc<size_t>;
+    std::list<size_t, list_alloc_t> list {list_alloc_t{shared_alloc<Alloc>()}};
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < 1000; ++i) { list.push_back(i); }
+        list.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK_TEMPLATE(BM_listPushClear, std::allocator<node_s>)
+    ->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_listPushClear, custom_allocator<node_s, concurrent_slab_arena>)
+    ->ThreadRange(1, 8)->UseRealTime();
+
+
+// Nodes are allocated by one thread and freed by another one.
+template <typename Alloc>
+void BM_producerConsumer(benchmark::State& state)
+{
+    using alloc_tt = std::allocator_traits<Alloc>;
+    Alloc alloc = shared_alloc<Alloc>();
+    channel_s& channel = g_channels[state.thread_index() / 2];
+    const bool producer = (state.thread_index() % 2 == 0);
+
+    std::vector<node_s*> batch;
+    for (auto _ : state)
+    {
+        if (producer)
+        {
+            batch.resize(BATCH_SIZE);
+            for (node_s*& node : batch) { node = alloc_tt::allocate(alloc, 1); }
+            std::lock_guard<std::mutex> lock {channel.mutex};
+            channel.batches.push_back(std::move(batch));
+            batch = {};
+            continue;
+        }
+        //NOTE: every consumer iteration frees a batch of its producer
+        for (;;)
+        {
+            {
+                std::lock_guard<std::mutex> lock {channel.mutex};
+                if (not channel.batches.empty())
+                {
+                    batch = std::move(channel.batches.back());
+                    channel.batches.pop_back();
+                    break;
+                }
+            }
+            std::this_thread::yield();
+        }
+        for (node_s* node : batch) { alloc_tt::deallocate(alloc, node, 1); }
+    }
+    //NOTE: a node is counted once, by its producer
+    if (producer) { state.SetItemsProcessed(state.iterations() * BATCH_SIZE); }
+}
+BENCHMARK_TEMPLATE(BM_producerConsumer, std::allocator<node_s>)
+    ->DenseThreadRange(2, 8, 2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_producerConsumer, custom_allocator<node_s, concurrent_slab_arena>)
+    ->DenseThreadRange(2, 8, 2)->UseRealTime();
+
+
+
+BENCHMARK_MAIN();
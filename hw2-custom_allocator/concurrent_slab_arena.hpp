@@ -0,0 +1,267 @@
+#pragma once
+
+#include <algorithm>    // std::find_if, std::remove_if
+#include <array>
+#include <atomic>
+#include <iterator>     // std::prev
+#include <limits>
+#include <memory>       // std::unique_ptr, std::shared_ptr, std::weak_ptr
+#include <mutex>
+#include <new>          // operator new
+#include <stdexcept>    // std::runtime_error
+#include <utility>      // std::exchange
+#include <vector>
+
+#include "common/debug.hpp"
+
+
+
+// A thread-safe arena for custom_allocator with the size classes of
+// slab_arena. Every thread keeps its own free lists of every class and
+// refills them by batches from the central depot (or returns them when
+// they grow too long), so the mutex of the depot is taken once per
+// BATCH_SIZE allocations. Bigger allocations go to operator new.
+//
+// A slot can be freed by any thread: it goes to the cache of that thread.
+// The caches of a finished thread go back to the depot. Slabs are freed
+// with the arena.
+class concurrent_slab_arena
+{
+    using buffer_t = std::unique_ptr<uint8_t[]>;
+
+    // A free slot keeps the pointer to the next free one.
+    struct free_slot_s
+    {
+        free_slot_s*    m_next;
+    };
+
+    // A list of free slots of one class.
+    struct batch_s
+    {
+        free_slot_s*    m_head  = nullptr;
+        size_t          m_count = 0;
+
+        void push(void* p) noexcept { m_head = new(p) free_slot_s{m_head}; ++m_count; }
+        void* pop() noexcept        { --m_count; return std::exchange(m_head, m_head->m_next); }
+        // Moves the first `n` slots to a new batch.
+        batch_s split(size_t n) noexcept
+        {
+            batch_s first {m_head, n};
+            free_slot_s* last = m_head;
+            for (size_t i = 1; i < n; ++i) { last = last->m_next; }
+            m_head = std::exchange(last->m_next, nullptr);
+            m_count -= n;
+            return first;
+        }
+    };
+
+public:
+    static constexpr size_t MIN_CLASS_SIZE = 8;
+    static constexpr size_t MAX_CLASS_SIZE = 256;
+    static constexpr size_t CLASSES_NUM    = 6;
+    static constexpr size_t SLAB_SIZE      = 4096;
+    // The slots moved between a thread cache and the depot at once.
+    static constexpr size_t BATCH_SIZE     = 32;
+    static constexpr size_t MAX_ALIGN      = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    static_assert(MIN_CLASS_SIZE << (CLASSES_NUM - 1) == MAX_CLASS_SIZE);
+
+private:
+    // The shared part: it lives while an arena or a thread cache with slots
+    // of the arena needs it.
+    struct depot_s
+    {
+        std::mutex                                     m_mutex;
+        std::vector<buffer_t>                          m_slabs;
+        std::array<std::vector<batch_s>, CLASSES_NUM>  m_batches;
+        // The uncarved rest of the last slab of every class.
+        std::array<uint8_t*, CLASSES_NUM>              m_slab_pos {};
+        std::array<uint8_t*, CLASSES_NUM>              m_slab_end {};
+        // The bytes of the slots given to the threads and not returned by
+        // batches, and the number of slabs. They're changed under the mutex
+        // but read without it.
+        std::atomic<size_t>                            m_used   {0};
+        std::atomic<size_t>                            m_blocks {0};
+    };
+
+    // The free lists of one thread for one arena.
+    struct thread_cache_s
+    {
+        uint64_t                                       m_arena_id;
+        std::weak_ptr<depot_s>                         m_depot;
+        std::array<batch_s, CLASSES_NUM>               m_classes {};
+    };
+
+    // All caches of a thread. Returns the slots to the live arenas when the
+    // thread finishes.
+    struct thread_caches_s
+    {
+        std::vector<std::unique_ptr<thread_cache_s>>   m_caches;
+        thread_cache_s*                                m_last = nullptr;
+
+        ~thread_caches_s()
+        {
+            for (auto& cache : m_caches)
+            {
+                if (std::shared_ptr<depot_s> depot = cache->m_depot.lock())
+                {
+                    std::lock_guard<std::mutex> lock {depot->m_mutex};
+                    for (size_t i = 0; i < CLASSES_NUM; ++i)
+                    {
+                        batch_s& batch = cache->m_classes[i];
+                        if (batch.m_count == 0) { continue; }
+                        depot->m_used.fetch_sub(batch.m_count * class_size(i), std::memory_order_relaxed);
+                        depot->m_batches[i].push_back(batch);
+                    }
+                }
+            }
+        }
+    };
+
+public:
+    concurrent_slab_arena()
+        : m_depot(std::make_shared<depot_s>())
+        , m_id(next_id())
+    { }
+    concurrent_slab_arena(const concurrent_slab_arena&)            = delete;
+    concurrent_slab_arena& operator=(const concurrent_slab_arena&) = delete;
+
+    // Every slot can keep a pointer.
+    static constexpr bool reuses(size_t, size_t) noexcept { return true; }
+
+    // `first_block` is ignored: the slabs have the same size.
+    void* allocate(size_t size, size_t align, [[maybe_unused]] size_t first_block = 0)
+    {
+        if (size > MAX_CLASS_SIZE) { return ::operator new(size); }
+        const size_t i = class_index(std::max(size, align));
+        batch_s& batch = local_cache().m_classes[i];
+        if (batch.m_count == 0) { batch = refill(i); }
+        return batch.pop();
+    }
+
+    void deallocate(void* p, size_t size, size_t align) noexcept
+    {
+        if (size > MAX_CLASS_SIZE) { ::operator delete(p); return; }
+        const size_t i = class_index(std::max(size, align));
+        //NOTE: a new cache can't be allocated, so the slot is lost
+        thread_cache_s* cache = nullptr;
+        try { cache = &local_cache(); }
+        catch (const std::bad_alloc&) { return; }
+
+        batch_s& batch = cache->m_classes[i];
+        batch.push(p);
+        if (batch.m_count >= 2 * BATCH_SIZE)
+        {
+            //NOTE: the recently freed slots stay in the cache
+            batch_s rest = batch.split(BATCH_SIZE);
+            std::swap(rest, batch);
+            give_back(i, rest);
+        }
+    }
+
+    // Limited by the memory only.
+    size_t max_size(size_t size, [[maybe_unused]] size_t align = 1,
+                    [[maybe_unused]] size_t first_block = 0) const noexcept
+    {
+        return std::numeric_limits<size_t>::max() / size;
+    }
+
+    // Drops all slabs, throws std::runtime_error if they were ever used:
+    // the thread caches may keep their slots.
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock {m_depot->m_mutex};
+        if (not m_depot->m_slabs.empty())
+        {
+            throw std::runtime_error("Allocator already contents some elements");
+        }
+    }
+
+    // The bytes of the slots given to the threads (the ones in their caches
+    // included), the big allocations aren't counted.
+    // Lock-free: a snapshot while other threads allocate.
+    size_t used()   const noexcept { return m_depot->m_used.load(std::memory_order_relaxed); }
+    size_t blocks() const noexcept { return m_depot->m_blocks.load(std::memory_order_relaxed); }
+
+private:
+    static uint64_t next_id() noexcept
+    {
+        static std::atomic<uint64_t> id {0};
+        return ++id;
+    }
+
+    static constexpr size_t class_size(size_t i) noexcept { return MIN_CLASS_SIZE << i; }
+
+    static size_t class_index(size_t size) noexcept
+    {
+        size_t i = 0;
+        while (class_size(i) < size) { ++i; }
+        return i;
+    }
+
+    thread_cache_s& local_cache()
+    {
+        thread_local thread_caches_s caches;
+        if (caches.m_last && caches.m_last->m_arena_id == m_id) { return *caches.m_last; }
+
+        auto it = std::find_if(caches.m_caches.begin(), caches.m_caches.end(),
+                               [this](const auto& cache) { return cache->m_arena_id == m_id; });
+        if (it == caches.m_caches.end())
+        {
+            //NOTE: the caches of the destroyed arenas are dropped here
+            caches.m_caches.erase(
+                std::remove_if(caches.m_caches.begin(), caches.m_caches.end(),
+                               [](const auto& cache) { return cache->m_depot.expired(); }),
+                caches.m_caches.end());
+            caches.m_caches.push_back(std::make_unique<thread_cache_s>(thread_cache_s{m_id, m_depot, {}}));
+            it = std::prev(caches.m_caches.end());
+        }
+        caches.m_last = it->get();
+        return *caches.m_last;
+    }
+
+    // A batch from the depot or from a slab.
+    batch_s refill(size_t i)
+    {
+        depot_s& depot = *m_depot;
+        std::lock_guard<std::mutex> lock {depot.m_mutex};
+        batch_s batch;
+        if (not depot.m_batches[i].empty())
+        {
+            batch = depot.m_batches[i].back();
+            depot.m_batches[i].pop_back();
+        }
+        else
+        {
+            while (batch.m_count != BATCH_SIZE)
+            {
+                if (depot.m_slab_pos[i] == depot.m_slab_end[i])
+                {
+                    buffer_t slab {new uint8_t[SLAB_SIZE]};
+                    depot.m_slabs.push_back(std::move(slab));
+                    depot.m_blocks.store(depot.m_slabs.size(), std::memory_order_relaxed);
+                    depot.m_slab_pos[i] = depot.m_slabs.back().get();
+                    depot.m_slab_end[i] = depot.m_slab_pos[i] + SLAB_SIZE;
+                    LM("[%p] \033[36m%s\033[0m    %zu: %p", (void*)this, __PRETTY_FUNCTION__,
+                       class_size(i), (void*)depot.m_slab_pos[i]);
+                }
+                batch.push(std::exchange(depot.m_slab_pos[i], depot.m_slab_pos[i] + class_size(i)));
+            }
+        }
+        depot.m_used.fetch_add(batch.m_count * class_size(i), std::memory_order_relaxed);
+        return batch;
+    }
+
+    void give_back(size_t i, const batch_s& batch) noexcept
+    {
+        std::lock_guard<std::mutex> lock {m_depot->m_mutex};
+        //NOTE: if the depot can't grow the slots stay taken
+        try { m_depot->m_batches[i].push_back(batch); }
+        catch (const std::bad_alloc&) { return; }
+        m_depot->m_used.fetch_sub(batch.m_count * class_size(i), std::memory_order_relaxed);
+    }
+
+    std::shared_ptr<depot_s>    m_depot;
+    // Identifies the caches of the arena: its address can be reused.
+    uint64_t                    m_id;
+};
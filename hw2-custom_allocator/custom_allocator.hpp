@@ -1,57 +1,73 @@
 #pragma once
 
-#include <memory>       // std::unique_ptr
-#include <stdexcept>    // std::runtime_error
+#include <memory>       // std::shared_ptr
+#include <new>          // std::bad_alloc
+#include <type_traits>  // std::true_type, std::enable_if_t, std::is_same_v
+#include <utility>      // std::declval
 
 #include "common/debug.hpp"
+#include "custom_arena.hpp"
+#include "slab_arena.hpp"
 
 
 
-template <typename T>
+// Copies and rebinds of the allocator share its arena, so all nodes of a
+// container come from the same blocks and allocators are equal if their
+// arenas are the same. The capacity is the number of elements of the
+// first allocating type the first block is sized for.
+//
+// The arena is custom_arena (chained blocks) or slab_arena (size classes,
+// the capacity is ignored). An arena can be passed to the allocators of
+// several containers, so they share its memory. The growth policy is of
+// custom_arena only, so are the constructor taking it and growth().
+template <typename T, typename Arena = custom_arena>
 class custom_allocator
 {
-    using buffer_t = std::unique_ptr<uint8_t[]>;
+    static_assert(alignof(T) <= Arena::MAX_ALIGN, "Over-aligned types aren't supported");
+    static_assert(noexcept(std::declval<const Arena&>().used()) && noexcept(std::declval<const Arena&>().blocks()),
+                  "size() and blocks() of the allocator are noexcept");
 
 public:
     using value_type = T;
 
-    template<typename U> struct rebind { using other = custom_allocator<U>; };
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap            = std::true_type;
+    using is_always_equal                        = std::false_type;
 
-    explicit custom_allocator(size_t capacity) : m_capacity(capacity) {}
-    custom_allocator() noexcept                              = default;
-    ~custom_allocator()                                      = default;
-    custom_allocator(custom_allocator&&) noexcept            = default;
+    template<typename U> struct rebind { using other = custom_allocator<U, Arena>; };
 
-    custom_allocator(const custom_allocator& o) noexcept
-        : m_capacity(o.m_capacity)
+    template <typename A = Arena, typename = std::enable_if_t<std::is_same_v<A, custom_arena>>>
+    explicit custom_allocator(size_t capacity, alloc_growth_e growth = alloc_growth_e::NONE)
+        : m_arena(std::make_shared<Arena>(growth))
+        , m_capacity(capacity)
     { }
+    explicit custom_allocator(std::shared_ptr<Arena> arena, size_t capacity = 0) noexcept
+        : m_arena(std::move(arena))
+        , m_capacity(capacity)
+    { }
+    custom_allocator() : m_arena(std::make_shared<Arena>()) { }
+    ~custom_allocator()                                        = default;
 
-    custom_allocator& operator=(custom_allocator&&) noexcept = default;
-    custom_allocator& operator=(const custom_allocator&)     = delete;
-    /*
-    {
-        if (this != &o)
-        {
-            m_buffer.reset();
-            m_size = o.m_size;
-            m_capacity = o.m_capacity;
-        }
-        return *this;
-    }
-    */
+    //NOTE: there are no move operations: a moved-from allocator has to
+    //      stay usable, so moving shares the arena like copying does
+    custom_allocator(const custom_allocator&) noexcept            = default;
+    custom_allocator& operator=(const custom_allocator&) noexcept = default;
 
     template<typename U>
-    custom_allocator(const custom_allocator<U>& o)
-        : m_capacity(o.capacity())
+    custom_allocator(const custom_allocator<U, Arena>& o) noexcept
+        : m_arena(o.arena())
+        , m_capacity(o.capacity())
     { }
 
 
+    // Freed slots are reused first, so node-based containers are bounded by
+    // live elements but not by all allocations.
     T* allocate(size_t n)
     {
-        LM("[%p] \033[32m%s\033[0m    n = %zu; m_size = %zu", (void*)this, __PRETTY_FUNCTION__, n, m_size);
+        LM("[%p] \033[32m%s\033[0m    n = %zu; size = %zu", (void*)this, __PRETTY_FUNCTION__, n, size());
         if (n > max_size()) { throw std::bad_alloc(); }
-        allocate_buffer_if_needed();
-        T* retval = get_first_element() + std::exchange(m_size, m_size + n);
+        T* retval = static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T), m_capacity * sizeof(T)));
         for (size_t i = 0; i < n; ++i)
         {
             LM("    %p", (void*)(retval + i));
@@ -66,10 +82,10 @@ public:
         new(p) U(std::forward<Args>(args)...);
     }
 
-    //TODO: deallocate when (m_size == 0)
-    void deallocate(T*, [[maybe_unused]] size_t n) noexcept
+    void deallocate(T* p, size_t n) noexcept
 	{
-        LM("[%p] \033[31m%s\033[0m    n = %zu; m_size = %zu", (void*)this, __PRETTY_FUNCTION__, n, m_size);
+        LM("[%p] \033[31m%s\033[0m    n = %zu; size = %zu", (void*)this, __PRETTY_FUNCTION__, n, size());
+        m_arena->deallocate(p, n * sizeof(T), alignof(T));
     }
 
     void destroy(T *p) noexcept
@@ -80,48 +96,41 @@ public:
 
     size_t max_size() const noexcept
 	{
-		size_t max_size = m_capacity - m_size;
+        size_t max_size = m_arena->max_size(sizeof(T), alignof(T), m_capacity * sizeof(T));
         LM("[%p] %s    max_size = %zu", (void*)this, __PRETTY_FUNCTION__, max_size);
         return max_size;
     }
-    size_t size()     const noexcept     { return m_size; }
+    // The elements taken from the arena (by all allocators sharing it), the
+    // unused tails of its full blocks included.
+    size_t size()     const noexcept     { return m_arena->used() / sizeof(T); }
     size_t capacity() const noexcept     { return m_capacity; }
     void capacity(size_t v)
     {
-        if (0 != m_size)
-        {
-            throw std::runtime_error("Allocator already contents some elements");
-        }
-        if (m_buffer) { m_buffer.reset(); }
+        m_arena->reset();
         m_capacity = v;
     }
+    template <typename A = Arena, typename = std::enable_if_t<std::is_same_v<A, custom_arena>>>
+    alloc_growth_e growth() const noexcept { return m_arena->growth(); }
+    size_t blocks()         const noexcept { return m_arena->blocks(); }
+    const std::shared_ptr<Arena>& arena() const noexcept { return m_arena; }
 
-private:
-    T* get_first_element() noexcept      { return reinterpret_cast<T*>(m_buffer.get()); }
+    // Whether freed elements are reused.
+    static constexpr bool REUSE_SLOTS = Arena::reuses(sizeof(T), alignof(T));
 
-	void allocate_buffer_if_needed()
-	{
-        if (m_buffer) { return; }
-        if (0 == m_capacity) { throw std::runtime_error("Unexpected empty capacity"); }
-        m_buffer.reset(new uint8_t[m_capacity * sizeof(value_type)]);
-
-		[[maybe_unused]] T const* p = (T*)m_buffer.get();
-        LM("[%p] \033[36m%s\033[0m", (void*)this, __PRETTY_FUNCTION__);
-        for (size_t i = 0; i < m_capacity; ++i)
-        {
-            LM("\t\033[36m%p\033[0m", (void*)(p + i));
-        }
-	}
-
-    buffer_t    m_buffer;
-    size_t      m_size     = 0;
-    size_t      m_capacity = 0;
+private:
+    std::shared_ptr<Arena>           m_arena;
+    size_t                           m_capacity = 0;
 };
 
 
-template <class T, class U>
-bool operator==(const custom_allocator<T>&, const custom_allocator<U>&) { return false; }
-
-template <class T, class U>
-bool operator!=(const custom_allocator<T>&, const custom_allocator<U>&) { return false; }
+template <class T, class U, class Arena>
+bool operator==(const custom_allocator<T, Arena>& l, const custom_allocator<U, Arena>& r) noexcept
+{
+    return l.arena() == r.arena();
+}
 
+template <class T, class U, class Arena>
+bool operator!=(const custom_allocator<T, Arena>& l, const custom_allocator<U, Arena>& r) noexcept
+{
+    return not (l == r);
+}
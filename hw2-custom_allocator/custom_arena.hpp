@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>    // std::max, std::find_if
+#include <limits>
+#include <memory>       // std::unique_ptr
+#include <new>          // std::bad_alloc
+#include <stdexcept>    // std::runtime_error
+#include <utility>      // std::exchange
+#include <vector>
+
+#include "common/debug.hpp"
+
+
+
+// What custom_arena does when its block is full.
+enum class alloc_growth_e
+{
+    NONE,       // throw std::bad_alloc
+    FIXED,      // chain a new block of the initial size
+    GEOMETRIC,  // chain a new block twice as big as the last one
+};
+
+
+
+// The memory of custom_allocator shared by all its copies and rebinds:
+// chained blocks of bytes handed out by a bump pointer plus free lists of
+// freed slots for every slot size and alignment. Blocks are freed with the
+// arena.
+class custom_arena
+{
+    using buffer_t = std::unique_ptr<uint8_t[]>;
+
+    // A freed slot keeps the pointer to the next free one.
+    struct free_slot_s
+    {
+        free_slot_s*    m_next;
+    };
+
+    //NOTE: a slot is aligned only by the alignment it was allocated with,
+    //      so slots of the same size and different alignments aren't mixed
+    struct free_list_s
+    {
+        size_t          m_slot_size;
+        size_t          m_slot_align;
+        free_slot_s*    m_head;
+    };
+
+public:
+    // The biggest alignment of the blocks.
+    static constexpr size_t MAX_ALIGN      = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+    // The smallest slot which can be kept by a free list.
+    static constexpr size_t MIN_SLOT_SIZE  = sizeof(free_slot_s);
+    static constexpr size_t MIN_SLOT_ALIGN = alignof(free_slot_s);
+
+    explicit custom_arena(alloc_growth_e growth = alloc_growth_e::NONE) noexcept
+        : m_growth(growth)
+    { }
+    custom_arena(const custom_arena&)            = delete;
+    custom_arena& operator=(const custom_arena&) = delete;
+
+    // Whether freed allocations of `size` bytes aligned by `align` are reused:
+    // a slot has to keep a pointer.
+    static constexpr bool reuses(size_t size, size_t align) noexcept
+    {
+        return size >= MIN_SLOT_SIZE && align >= MIN_SLOT_ALIGN;
+    }
+
+    // A freed slot of the same size and alignment is taken first. `first_block` is the size
+    // of the first block (of every block for FIXED growth) if there are no
+    // blocks yet.
+    void* allocate(size_t size, size_t align, size_t first_block)
+    {
+        if (reuses(size, align))
+        {
+            if (void* slot = allocate_slot(size, align)) { return slot; }
+        }
+        size_t offset = align_up(m_block_size, align);
+        if (m_blocks.empty() || size > m_block_capacity - std::min(offset, m_block_capacity))
+        {
+            allocate_block(size, first_block);
+            offset = 0;
+        }
+        void* p = m_blocks.back().get() + offset;
+        m_used      += offset + size - m_block_size;
+        m_block_size = offset + size;
+        return p;
+    }
+
+    //NOTE: the memory is kept for allocations of the same size and
+    //      alignment if it can be reused, otherwise it stays occupied
+    void deallocate(void* p, size_t size, size_t align) noexcept
+    {
+        if (not reuses(size, align)) { return; }
+        free_list_s* list = find_free_list(size, align);
+        if (not list)
+        {
+            //NOTE: there are few node types, a failed push just loses the slot
+            try { list = &m_free_lists.emplace_back(free_list_s{size, align, nullptr}); }
+            catch (const std::bad_alloc&) { return; }
+        }
+        list->m_head = new(p) free_slot_s{list->m_head};
+    }
+
+    // The number of allocations of `size` bytes aligned by `align` which can
+    // be made at once. A growing arena is limited by the memory only.
+    size_t max_size(size_t size, size_t align, size_t first_block) const noexcept
+    {
+        if (m_growth != alloc_growth_e::NONE) { return std::numeric_limits<size_t>::max() / size; }
+        const size_t max_size = (m_blocks.empty() ? first_block : available()) / size;
+        return (max_size == 0 && has_slot(size, align)) ? 1 : max_size;
+    }
+
+    // Drops all blocks, throws std::runtime_error if something is allocated.
+    void reset()
+    {
+        if (0 != m_used)
+        {
+            throw std::runtime_error("Allocator already contents some elements");
+        }
+        m_blocks.clear();
+        m_free_lists.clear();
+        m_block_size     = 0;
+        m_block_capacity = 0;
+    }
+
+    // The bytes taken from the blocks: freed slots and the unused tails of the
+    // full blocks are included.
+    size_t used()      const noexcept { return m_used; }
+    // The bytes left in the last block.
+    size_t available() const noexcept { return m_block_capacity - m_block_size; }
+    size_t blocks()    const noexcept { return m_blocks.size(); }
+    alloc_growth_e growth() const noexcept { return m_growth; }
+
+private:
+    bool has_slot(size_t size, size_t align) const noexcept
+    {
+        for (const free_list_s& list : m_free_lists)
+        {
+            if (list.m_slot_size == size && list.m_slot_align == align) { return list.m_head != nullptr; }
+        }
+        return false;
+    }
+
+    // Takes a freed slot of `size` bytes aligned by `align` or returns nullptr.
+    void* allocate_slot(size_t size, size_t align) noexcept
+    {
+        free_list_s* list = find_free_list(size, align);
+        if (not list || not list->m_head) { return nullptr; }
+        return std::exchange(list->m_head, list->m_head->m_next);
+    }
+
+    static size_t align_up(size_t v, size_t align) noexcept { return (v + align - 1) / align * align; }
+
+    free_list_s* find_free_list(size_t size, size_t align) noexcept
+    {
+        auto it = std::find_if(m_free_lists.begin(), m_free_lists.end(), [size, align](const free_list_s& l)
+        {
+            return l.m_slot_size == size && l.m_slot_align == align;
+        });
+        return (it != m_free_lists.end()) ? &*it : nullptr;
+    }
+
+    // Chains a new block for `size` bytes at least. The allocations of the
+    // previous blocks keep their addresses.
+    void allocate_block(size_t size, size_t first_block)
+    {
+        size_t capacity = first_block;
+        if (not m_blocks.empty())
+        {
+            switch (m_growth)
+            {
+                case alloc_growth_e::NONE:      throw std::bad_alloc();
+                case alloc_growth_e::FIXED:     capacity = m_first_block; break;
+                case alloc_growth_e::GEOMETRIC: capacity = m_block_capacity * 2; break;
+            }
+        }
+        capacity = std::max(capacity, size);
+        if (0 == capacity) { throw std::bad_alloc(); }
+        buffer_t block {new uint8_t[capacity]};
+        m_blocks.push_back(std::move(block));
+        if (m_blocks.size() == 1) { m_first_block = capacity; }
+        //NOTE: the tail of the full block is left unused and counted as taken,
+        //      a free list takes slots of one size only
+        m_used          += m_block_capacity - m_block_size;
+        m_block_size     = 0;
+        m_block_capacity = capacity;
+        LM("[%p] \033[36m%s\033[0m    %p: %zu bytes", (void*)this, __PRETTY_FUNCTION__,
+           (void*)m_blocks.back().get(), capacity);
+    }
+
+    //NOTE: the blocks are freed one by one with the arena
+    std::vector<buffer_t>       m_blocks;
+    std::vector<free_list_s>    m_free_lists;
+    alloc_growth_e              m_growth;
+    size_t                      m_used           = 0;
+    size_t                      m_first_block    = 0;
+    // Taken and all bytes of the last block.
+    size_t                      m_block_size     = 0;
+    size_t                      m_block_capacity = 0;
+};
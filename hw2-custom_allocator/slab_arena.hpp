@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>    // std::max
+#include <array>
+#include <limits>
+#include <memory>       // std::unique_ptr
+#include <new>          // std::bad_alloc, operator new
+#include <stdexcept>    // std::runtime_error
+#include <utility>      // std::exchange
+#include <vector>
+
+#include "common/debug.hpp"
+
+
+
+struct slab_class_stats_s
+{
+    size_t    slot_size  = 0;
+    size_t    slabs      = 0;
+    // Slots given out and not freed.
+    size_t    live_slots = 0;
+    // Slots freed or not carved from the slabs yet.
+    size_t    free_slots = 0;
+};
+
+
+
+struct slab_stats_s
+{
+    static constexpr size_t CLASSES_NUM = 6;
+
+    std::array<slab_class_stats_s, CLASSES_NUM> classes {};
+    // The bytes asked by the live allocations.
+    size_t    requested_bytes      = 0;
+    // The bytes of the slots (or of the big allocations) they occupy.
+    size_t    occupied_bytes       = 0;
+    // The bytes of the slabs and the big allocations.
+    size_t    reserved_bytes       = 0;
+    size_t    peak_requested_bytes = 0;
+    size_t    peak_reserved_bytes  = 0;
+    // The allocations bigger than the biggest class.
+    size_t    big_allocations      = 0;
+
+    // The part of the occupied bytes lost to rounding up to the class size.
+    double internal_fragmentation() const noexcept
+    {
+        return occupied_bytes ? 1.0 - double(requested_bytes) / occupied_bytes : 0.0;
+    }
+    // The part of the reserved bytes which isn't occupied.
+    double external_fragmentation() const noexcept
+    {
+        return reserved_bytes ? 1.0 - double(occupied_bytes) / reserved_bytes : 0.0;
+    }
+};
+
+
+
+// An arena for custom_allocator serving allocations by size classes of
+// 8..256 bytes from page-sized slabs. Every class has its own free list, so
+// any freed slot is reused and allocators of different node types share
+// the slabs. Bigger allocations go to operator new. Slabs are freed with
+// the arena.
+class slab_arena
+{
+    using buffer_t = std::unique_ptr<uint8_t[]>;
+
+    // A freed slot keeps the pointer to the next free one.
+    struct free_slot_s
+    {
+        free_slot_s*    m_next;
+    };
+
+    struct class_s
+    {
+        free_slot_s*    m_free_list = nullptr;
+        // The uncarved rest of the last slab of the class.
+        uint8_t*        m_slab_pos  = nullptr;
+        uint8_t*        m_slab_end  = nullptr;
+    };
+
+public:
+    static constexpr size_t MIN_CLASS_SIZE = 8;
+    static constexpr size_t MAX_CLASS_SIZE = 256;
+    static constexpr size_t CLASSES_NUM    = slab_stats_s::CLASSES_NUM;
+    static constexpr size_t SLAB_SIZE      = 4096;
+    // Slots are aligned by their size up to the alignment of the slabs.
+    static constexpr size_t MAX_ALIGN      = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    static_assert(MIN_CLASS_SIZE << (CLASSES_NUM - 1) == MAX_CLASS_SIZE);
+    static_assert(MIN_CLASS_SIZE >= sizeof(free_slot_s));
+
+    slab_arena() noexcept
+    {
+        for (size_t i = 0; i < CLASSES_NUM; ++i) { m_stats.classes[i].slot_size = MIN_CLASS_SIZE << i; }
+    }
+    ~slab_arena() = default;
+    slab_arena(const slab_arena&)            = delete;
+    slab_arena& operator=(const slab_arena&) = delete;
+
+    // Every slot can keep a pointer.
+    static constexpr bool reuses(size_t, size_t) noexcept { return true; }
+
+    // `first_block` is ignored: the slabs have the same size.
+    void* allocate(size_t size, size_t align, [[maybe_unused]] size_t first_block = 0)
+    {
+        void* p = nullptr;
+        if (size > MAX_CLASS_SIZE)
+        {
+            p = ::operator new(size);
+            ++m_stats.big_allocations;
+            m_stats.occupied_bytes += size;
+            m_stats.reserved_bytes += size;
+        }
+        else
+        {
+            const size_t i = class_index(std::max(size, align));
+            class_s& c = m_classes[i];
+            if (c.m_free_list)
+            {
+                p = std::exchange(c.m_free_list, c.m_free_list->m_next);
+            }
+            else
+            {
+                if (c.m_slab_pos == c.m_slab_end) { allocate_slab(i); }
+                p = std::exchange(c.m_slab_pos, c.m_slab_pos + class_size(i));
+            }
+            slab_class_stats_s& cs = m_stats.classes[i];
+            --cs.free_slots;
+            ++cs.live_slots;
+            m_stats.occupied_bytes += class_size(i);
+        }
+        m_stats.requested_bytes      += size;
+        m_stats.peak_requested_bytes  = std::max(m_stats.peak_requested_bytes, m_stats.requested_bytes);
+        m_stats.peak_reserved_bytes   = std::max(m_stats.peak_reserved_bytes, m_stats.reserved_bytes);
+        LM("[%p] \033[32m%s\033[0m    %zu bytes: %p", (void*)this, __PRETTY_FUNCTION__, size, p);
+        return p;
+    }
+
+    void deallocate(void* p, size_t size, size_t align) noexcept
+    {
+        LM("[%p] \033[31m%s\033[0m    %zu bytes: %p", (void*)this, __PRETTY_FUNCTION__, size, p);
+        m_stats.requested_bytes -= size;
+        if (size > MAX_CLASS_SIZE)
+        {
+            ::operator delete(p);
+            --m_stats.big_allocations;
+            m_stats.occupied_bytes -= size;
+            m_stats.reserved_bytes -= size;
+            return;
+        }
+        const size_t i = class_index(std::max(size, align));
+        m_classes[i].m_free_list = new(p) free_slot_s{m_classes[i].m_free_list};
+        slab_class_stats_s& cs = m_stats.classes[i];
+        ++cs.free_slots;
+        --cs.live_slots;
+        m_stats.occupied_bytes -= class_size(i);
+    }
+
+    // Limited by the memory only.
+    size_t max_size(size_t size, [[maybe_unused]] size_t align = 1,
+                    [[maybe_unused]] size_t first_block = 0) const noexcept
+    {
+        return std::numeric_limits<size_t>::max() / size;
+    }
+
+    // Drops all slabs, throws std::runtime_error if something is allocated.
+    void reset()
+    {
+        if (0 != m_stats.occupied_bytes)
+        {
+            throw std::runtime_error("Allocator already contents some elements");
+        }
+        m_slabs.clear();
+        m_classes = {};
+        for (slab_class_stats_s& cs : m_stats.classes) { cs.slabs = cs.free_slots = 0; }
+        m_stats.reserved_bytes = 0;
+    }
+
+    // The bytes of the occupied slots and big allocations.
+    size_t used()   const noexcept { return m_stats.occupied_bytes; }
+    size_t blocks() const noexcept { return m_slabs.size(); }
+    const slab_stats_s& stats() const noexcept { return m_stats; }
+
+private:
+    static constexpr size_t class_size(size_t i) noexcept { return MIN_CLASS_SIZE << i; }
+
+    static size_t class_index(size_t size) noexcept
+    {
+        size_t i = 0;
+        while (class_size(i) < size) { ++i; }
+        return i;
+    }
+
+    void allocate_slab(size_t i)
+    {
+        buffer_t slab {new uint8_t[SLAB_SIZE]};
+        m_slabs.push_back(std::move(slab));
+        class_s& c = m_classes[i];
+        c.m_slab_pos = m_slabs.back().get();
+        c.m_slab_end = c.m_slab_pos + SLAB_SIZE;
+
+        slab_class_stats_s& cs = m_stats.classes[i];
+        ++cs.slabs;
+        cs.free_slots          += SLAB_SIZE / class_size(i);
+        m_stats.reserved_bytes += SLAB_SIZE;
+        LM("[%p] \033[36m%s\033[0m    %zu: %p", (void*)this, __PRETTY_FUNCTION__, class_size(i),
+           (void*)c.m_slab_pos);
+    }
+
+    std::vector<buffer_t>                   m_slabs;
+    std::array<class_s, CLASSES_NUM>        m_classes {};
+    slab_stats_s                            m_stats;
+};
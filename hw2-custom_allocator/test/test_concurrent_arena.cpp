@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "custom_allocator.hpp"
+#include "concurrent_slab_arena.hpp"
+
+
+
+namespace {
+
+struct node_s
+{
+    node_s*    next;
+    size_t     value;
+};
+
+using node_alloc_t = custom_allocator<node_s, concurrent_slab_arena>;
+
+} // namespace
+
+
+
+TEST(ConcurrentSlabArena, threadCaches)
+{
+    auto arena = std::make_shared<concurrent_slab_arena>();
+    std::thread thread {[arena]
+    {
+        node_alloc_t alloc {arena};
+        std::vector<node_s*> nodes;
+        for (size_t i = 0; i < 3 * concurrent_slab_arena::BATCH_SIZE; ++i) { nodes.push_back(alloc.allocate(1)); }
+        EXPECT_EQ(1, arena->blocks());
+        EXPECT_EQ(nodes.size() * sizeof(node_s), arena->used());
+
+        //NOTE: the freed slots are taken back in the reverse order
+        alloc.deallocate(nodes[1], 1);
+        alloc.deallocate(nodes[0], 1);
+        EXPECT_EQ(nodes[0], alloc.allocate(1));
+        EXPECT_EQ(nodes[1], alloc.allocate(1));
+
+        //NOTE: long free lists go back to the depot by batches
+        for (node_s* node : nodes) { alloc.deallocate(node, 1); }
+        EXPECT_EQ(concurrent_slab_arena::BATCH_SIZE * sizeof(node_s), arena->used());
+    }};
+    thread.join();
+
+    //NOTE: the cache of a finished thread goes back to the depot
+    EXPECT_EQ(0u, arena->used());
+    EXPECT_EQ(1, arena->blocks());
+    ASSERT_THROW(arena->reset(), std::runtime_error);
+}
+
+
+TEST(ConcurrentSlabArena, producersAndConsumers)
+{
+    constexpr size_t PAIRS     = 4;
+    constexpr size_t NODES_NUM = 20'000;
+
+    auto arena = std::make_shared<concurrent_slab_arena>();
+    struct channel_s
+    {
+        std::mutex              mutex;
+        std::vector<node_s*>    nodes;
+        bool                    done = false;
+    };
+    std::vector<channel_s> channels(PAIRS);
+    std::vector<size_t>    sums(PAIRS, 0);
+
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < PAIRS; ++p)
+    {
+        threads.emplace_back([&, p]
+        {
+            node_alloc_t alloc {arena};
+            for (size_t i = 0; i < NODES_NUM; ++i)
+            {
+                node_s* node = alloc.allocate(1);
+                node->value = i;
+                std::lock_guard<std::mutex> lock {channels[p].mutex};
+                channels[p].nodes.push_back(node);
+            }
+            std::lock_guard<std::mutex> lock {channels[p].mutex};
+            channels[p].done = true;
+        });
+        //NOTE: the nodes are freed by another thread
+        threads.emplace_back([&, p]
+        {
+            node_alloc_t alloc {arena};
+            std::vector<node_s*> nodes;
+            for (bool done = false; not done; )
+            {
+                {
+                    std::lock_guard<std::mutex> lock {channels[p].mutex};
+                    nodes.swap(channels[p].nodes);
+                    done = channels[p].done;
+                }
+                for (node_s* node : nodes)
+                {
+                    sums[p] += node->value;
+                    alloc.deallocate(node, 1);
+                }
+                nodes.clear();
+                std::this_thread::yield();
+            }
+            //NOTE: a map of its own nodes by the shared arena
+            std::map<int, int, std::less<int>, custom_allocator<std::pair<const int, int>, concurrent_slab_arena>>
+                map {alloc};
+            for (int i = 0; i < 1000; ++i) { map[i] = i; }
+            EXPECT_EQ(1000u, map.size());
+        });
+    }
+    for (std::thread& thread : threads) { thread.join(); }
+
+    for (size_t p = 0; p < PAIRS; ++p) { EXPECT_EQ(NODES_NUM * (NODES_NUM - 1) / 2, sums[p]); }
+    EXPECT_EQ(0u, arena->used());
+}
@@ -94,28 +94,39 @@ TEST(CustomAllocator, capacityCtor)
 
 TEST(CustomAllocator, copyCtor)
 {
-    custom_allocator<int> alloc_1 {3};
-    EXPECT_EQ(3, alloc_1.capacity());
+    custom_allocator<int> alloc_1 {4};
+    EXPECT_EQ(4, alloc_1.capacity());
     EXPECT_EQ(0, alloc_1.size());
     int* pi = nullptr;
     ASSERT_NO_THROW({ pi = alloc_1.allocate(1); });
     ASSERT_NE(nullptr, pi);
     EXPECT_EQ(1, alloc_1.size());
 
+    //NOTE: copies and rebinds share the arena, a double is aligned after
+    //      the int
     custom_allocator<double> alloc_2 {alloc_1};
-    EXPECT_EQ(3, alloc_2.capacity());
-    EXPECT_EQ(0, alloc_2.size());
-    ASSERT_FALSE(alloc_1 == alloc_2);
+    EXPECT_EQ(4, alloc_2.capacity());
+    ASSERT_TRUE(alloc_1 == alloc_2);
     ASSERT_FALSE(alloc_1 != alloc_2);
+    double* pd = nullptr;
+    ASSERT_NO_THROW({ pd = alloc_2.allocate(1); });
+    EXPECT_EQ(reinterpret_cast<char*>(pi) + sizeof(double), reinterpret_cast<char*>(pd));
 
     custom_allocator<int> alloc_3 = alloc_1;
-    EXPECT_EQ(3, alloc_3.capacity());
-    EXPECT_EQ(0, alloc_3.size());
-    ASSERT_FALSE(alloc_1 == alloc_3);
+    EXPECT_EQ(4, alloc_3.capacity());
+    EXPECT_EQ(4, alloc_3.size());
+    ASSERT_TRUE(alloc_1 == alloc_3);
     ASSERT_FALSE(alloc_1 != alloc_3);
 
+    custom_allocator<int> alloc_4 {3};
+    ASSERT_FALSE(alloc_1 == alloc_4);
+    ASSERT_TRUE(alloc_1 != alloc_4);
+    alloc_4 = alloc_1;
+    ASSERT_TRUE(alloc_1 == alloc_4);
+
     ASSERT_NO_THROW({ alloc_1.deallocate(pi, 1); });
-    EXPECT_EQ(1, alloc_1.size());
+    EXPECT_EQ(4, alloc_1.size());
+    ASSERT_THROW(UNUSED(alloc_3.allocate(1)), std::bad_alloc);
 }
 
 
@@ -171,3 +182,177 @@ TEST(CustomAllocator, inMap)
     ASSERT_NO_THROW({ map[2] = 2; });
     ASSERT_THROW(map.insert({3,3}), std::bad_alloc);
 }
+
+
+TEST(CustomAllocator, freeListReuse)
+{
+    struct node_s { void* p; size_t v; };
+    using alloc_t  = custom_allocator<node_s>;
+    using alloc_tt = std::allocator_traits<alloc_t>;
+    static_assert(alloc_t::REUSE_SLOTS);
+    static_assert(not custom_allocator<char>::REUSE_SLOTS);
+
+    alloc_t alloc {3};
+    node_s* p1 = alloc_tt::allocate(alloc, 1);
+    node_s* p2 = alloc_tt::allocate(alloc, 1);
+    node_s* p3 = alloc_tt::allocate(alloc, 1);
+    EXPECT_EQ(3, alloc.size());
+    EXPECT_EQ(0, alloc_tt::max_size(alloc));
+    ASSERT_THROW(UNUSED(alloc_tt::allocate(alloc, 1)), std::bad_alloc);
+
+    //NOTE: the last freed slot is reused first
+    alloc_tt::deallocate(alloc, p2, 1);
+    alloc_tt::deallocate(alloc, p1, 1);
+    EXPECT_EQ(1, alloc_tt::max_size(alloc));
+    ASSERT_THROW(UNUSED(alloc_tt::allocate(alloc, 2)), std::bad_alloc);
+    EXPECT_EQ(p1, alloc_tt::allocate(alloc, 1));
+    EXPECT_EQ(p2, alloc_tt::allocate(alloc, 1));
+    ASSERT_THROW(UNUSED(alloc_tt::allocate(alloc, 1)), std::bad_alloc);
+    EXPECT_EQ(3, alloc.size());
+
+    //NOTE: the free list is shared by the moved allocator
+    alloc_tt::deallocate(alloc, p3, 1);
+    alloc_t alloc_2 {std::move(alloc)};
+    EXPECT_TRUE(alloc == alloc_2);
+    EXPECT_EQ(p3, alloc_tt::allocate(alloc_2, 1));
+    EXPECT_EQ(0, alloc_tt::max_size(alloc));
+}
+
+
+
+TEST(CustomAllocator, freeListAlignment)
+{
+    struct node_s { void* p; size_t v; };
+    struct alignas(16) aligned_s { char c[16]; };
+    static_assert(sizeof(node_s) == sizeof(aligned_s));
+
+    //NOTE: the word makes the node slot aligned by 8 but not by 16
+    custom_allocator<uint64_t> alloc {8};
+    custom_allocator<node_s> node_alloc {alloc};
+    custom_allocator<aligned_s> aligned_alloc {alloc};
+    uint64_t* word = alloc.allocate(1);
+    node_s* node = node_alloc.allocate(1);
+    node_alloc.deallocate(node, 1);
+
+    aligned_s* aligned = aligned_alloc.allocate(1);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(aligned) % alignof(aligned_s));
+    EXPECT_NE(static_cast<void*>(node), static_cast<void*>(aligned));
+    EXPECT_EQ(static_cast<void*>(node), static_cast<void*>(node_alloc.allocate(1)));
+    aligned_alloc.deallocate(aligned, 1);
+    alloc.deallocate(word, 1);
+
+    //NOTE: a run of two words is a slot of the same size as the node
+    custom_allocator<uint64_t> run_alloc {8};
+    custom_allocator<aligned_s> run_aligned_alloc {run_alloc};
+    word = run_alloc.allocate(1);
+    uint64_t* run = run_alloc.allocate(2);
+    ASSERT_NE(0, reinterpret_cast<uintptr_t>(run) % alignof(aligned_s));
+    run_alloc.deallocate(run, 2);
+    aligned = run_aligned_alloc.allocate(1);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(aligned) % alignof(aligned_s));
+    EXPECT_EQ(run, run_alloc.allocate(2));
+    run_alloc.deallocate(word, 1);
+}
+
+
+TEST(CustomAllocator, inMapChurn)
+{
+    using alloc_t = custom_allocator<std::pair<const int, int>>;
+    alloc_t alloc {2};
+    std::map<int, int, std::less<int>, alloc_t> map {alloc};
+    for (int i = 0; i < 1000; ++i)
+    {
+        ASSERT_NO_THROW({ map[i] = i; }) << "i = " << i;
+        ASSERT_NO_THROW({ map[i + 1] = i; }) << "i = " << i;
+        map.erase(i);
+        map.erase(i + 1);
+    }
+    EXPECT_TRUE(map.empty());
+    ASSERT_NO_THROW({ map[1] = 1; });
+    ASSERT_NO_THROW({ map[2] = 2; });
+    ASSERT_THROW(map.insert({3,3}), std::bad_alloc);
+}
+
+
+TEST(CustomAllocator, growth)
+{
+    using alloc_t  = custom_allocator<size_t>;
+    using alloc_tt = std::allocator_traits<alloc_t>;
+
+    alloc_t alloc_none {2};
+    EXPECT_EQ(alloc_growth_e::NONE, alloc_none.growth());
+    ASSERT_NO_THROW(UNUSED(alloc_tt::allocate(alloc_none, 2)));
+    ASSERT_THROW(UNUSED(alloc_tt::allocate(alloc_none, 1)), std::bad_alloc);
+    EXPECT_EQ(1, alloc_none.blocks());
+
+    alloc_t alloc_fixed {2, alloc_growth_e::FIXED};
+    std::vector<size_t*> ptrs;
+    for (size_t i = 0; i < 7; ++i)
+    {
+        ASSERT_NO_THROW({ ptrs.push_back(alloc_tt::allocate(alloc_fixed, 1)); }) << "i = " << i;
+        alloc_tt::construct(alloc_fixed, ptrs.back(), i);
+    }
+    EXPECT_EQ(4, alloc_fixed.blocks());
+    EXPECT_EQ(2, alloc_fixed.capacity());
+    //NOTE: a run bigger than the block gets its own block
+    ASSERT_NO_THROW(UNUSED(alloc_tt::allocate(alloc_fixed, 5)));
+    EXPECT_EQ(5, alloc_fixed.blocks());
+    //NOTE: the unused tail of the 4th block is counted
+    EXPECT_EQ(7 + 1 + 5, alloc_fixed.size());
+    for (size_t i = 0; i < ptrs.size(); ++i) { EXPECT_EQ(i, *ptrs[i]); }
+
+    alloc_t alloc_geom {1, alloc_growth_e::GEOMETRIC};
+    for (size_t i = 0; i < 15; ++i) { ASSERT_NO_THROW(UNUSED(alloc_tt::allocate(alloc_geom, 1))); }
+    //NOTE: 1 + 2 + 4 + 8
+    EXPECT_EQ(4, alloc_geom.blocks());
+    EXPECT_EQ(15, alloc_geom.size());
+
+    custom_allocator<int> alloc_rebound {alloc_geom};
+    EXPECT_EQ(alloc_growth_e::GEOMETRIC, alloc_rebound.growth());
+    EXPECT_EQ(4, alloc_rebound.blocks());
+}
+
+
+TEST(CustomAllocator, inMapGrowth)
+{
+    using alloc_t = custom_allocator<std::pair<const int, int>>;
+    alloc_t alloc {2, alloc_growth_e::GEOMETRIC};
+    std::map<int, int, std::less<int>, alloc_t> map {alloc};
+    for (int i = 0; i < 100; ++i) { ASSERT_NO_THROW({ map[i] = i; }) << "i = " << i; }
+    const int* first = &map[0];
+    for (int i = 100; i < 1000; ++i) { map[i] = i; }
+    EXPECT_EQ(first, &map[0]);
+    EXPECT_EQ(1000u, map.size());
+    for (int i = 0; i < 1000; ++i) { ASSERT_EQ(i, map[i]); }
+}
+
+
+TEST(CustomAllocator, sharedArena)
+{
+    using alloc_t = custom_allocator<std::pair<const int, int>>;
+    using map_t   = std::map<int, int, std::less<int>, alloc_t>;
+    alloc_t alloc {5};
+    map_t map_1 {alloc};
+    map_t map_2 {alloc};
+    map_1[1] = 1;
+    map_2[2] = 2;
+    map_1[3] = 3;
+    EXPECT_EQ(map_1.get_allocator(), map_2.get_allocator());
+
+    //NOTE: both maps took nodes from the one block
+    EXPECT_EQ(1, alloc.blocks());
+    const auto* n1 = reinterpret_cast<const char*>(&*map_1.find(1));
+    const auto* n2 = reinterpret_cast<const char*>(&*map_2.find(2));
+    const auto* n3 = reinterpret_cast<const char*>(&*map_1.find(3));
+    EXPECT_EQ(n2 - n1, n3 - n2);
+
+    //NOTE: the allocators are equal, so the nodes are just relinked
+    std::swap(map_1, map_2);
+    EXPECT_EQ(n2, reinterpret_cast<const char*>(&*map_1.find(2)));
+    map_t map_3 {std::move(map_2)};
+    EXPECT_EQ(n1, reinterpret_cast<const char*>(&*map_3.find(1)));
+    map_2 = map_3;
+    EXPECT_EQ(map_3, map_2);
+    EXPECT_EQ(map_3.get_allocator(), map_2.get_allocator());
+    ASSERT_THROW(map_2[4] = 4, std::bad_alloc);
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <list>
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+
+#include "custom_allocator.hpp"
+#include "concurrent_slab_arena.hpp"
+#include "custom_list.hpp"
+
+
+
+//NOTE: only custom_arena has a growth policy
+static_assert(std::is_constructible_v<custom_allocator<int>, size_t, alloc_growth_e>);
+static_assert(not std::is_constructible_v<custom_allocator<int, slab_arena>, size_t, alloc_growth_e>);
+static_assert(not std::is_constructible_v<custom_allocator<int, concurrent_slab_arena>, size_t>);
+
+
+
+TEST(SlabArena, sizeClasses)
+{
+    slab_arena arena;
+    void* p8  = arena.allocate(3, 1);
+    void* p16 = arena.allocate(16, 8);
+    void* p24 = arena.allocate(24, 8);
+    EXPECT_EQ(3, arena.blocks());
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(p16) % 16);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(p24) % 16);
+
+    const slab_stats_s& stats = arena.stats();
+    EXPECT_EQ(8u,  stats.classes[0].slot_size);
+    EXPECT_EQ(256u, stats.classes[5].slot_size);
+    EXPECT_EQ(1u, stats.classes[0].live_slots);
+    EXPECT_EQ(slab_arena::SLAB_SIZE / 8 - 1, stats.classes[0].free_slots);
+    EXPECT_EQ(3u + 16 + 24, stats.requested_bytes);
+    EXPECT_EQ(8u + 16 + 32, stats.occupied_bytes);
+    EXPECT_EQ(3 * slab_arena::SLAB_SIZE, stats.reserved_bytes);
+    EXPECT_DOUBLE_EQ(1.0 - 43.0 / 56.0, stats.internal_fragmentation());
+    EXPECT_DOUBLE_EQ(1.0 - 56.0 / (3 * slab_arena::SLAB_SIZE), stats.external_fragmentation());
+
+    //NOTE: a freed slot is reused by any allocation of its class
+    arena.deallocate(p24, 24, 8);
+    EXPECT_EQ(p24, arena.allocate(32, 8));
+    arena.deallocate(p8, 3, 1);
+    EXPECT_EQ(p8, arena.allocate(8, 8));
+
+    void* big = arena.allocate(1000, 8);
+    EXPECT_EQ(1u, stats.big_allocations);
+    EXPECT_EQ(3 * slab_arena::SLAB_SIZE + 1000, stats.reserved_bytes);
+    arena.deallocate(big, 1000, 8);
+    EXPECT_EQ(0u, stats.big_allocations);
+    EXPECT_EQ(3 * slab_arena::SLAB_SIZE + 1000, stats.peak_reserved_bytes);
+
+    ASSERT_THROW(arena.reset(), std::runtime_error);
+    arena.deallocate(p8, 8, 8);
+    arena.deallocate(p16, 16, 8);
+    arena.deallocate(p24, 32, 8);
+    EXPECT_EQ(0u, arena.used());
+    ASSERT_NO_THROW(arena.reset());
+    EXPECT_EQ(0, arena.blocks());
+    EXPECT_EQ(0u, stats.reserved_bytes);
+}
+
+
+TEST(SlabArena, sharedByContainers)
+{
+    auto arena = std::make_shared<slab_arena>();
+    {
+        custom_allocator<int, slab_arena> alloc {arena};
+        std::map<int, int, std::less<int>, custom_allocator<std::pair<const int, int>, slab_arena>> map {alloc};
+        std::list<int, custom_allocator<int, slab_arena>> list {alloc};
+        std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                           custom_allocator<std::pair<const int, int>, slab_arena>> umap {alloc};
+        custom_list<int, custom_allocator<int, slab_arena>> clist {alloc};
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            map[i] = i;
+            list.push_back(i);
+            umap[i] = i;
+            clist.push_back(i);
+        }
+        for (int i = 0; i < 1000; ++i) { ASSERT_EQ(i, map[i]); ASSERT_EQ(i, umap[i]); }
+        EXPECT_EQ(1000u, list.size());
+        EXPECT_EQ(1000u, clist.size());
+
+        //NOTE: the nodes of std::unordered_map and custom_list are of the
+        //      same class, so they reuse each other's slots
+        const size_t slabs = arena->blocks();
+        for (int i = 0; i < 1000; ++i) { umap.erase(i); }
+        for (int i = 0; i < 1000; ++i) { clist.push_back(i); }
+        EXPECT_EQ(slabs, arena->blocks());
+        map.clear();
+        EXPECT_GT(arena->stats().peak_requested_bytes, arena->stats().requested_bytes);
+    }
+    EXPECT_EQ(0u, arena->used());
+    EXPECT_EQ(0u, arena->stats().requested_bytes);
+}